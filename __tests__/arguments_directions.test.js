@@ -36,6 +36,18 @@ describe('Arguments direction', () => {
   });
 
   describe('out', () => {
+    test('integers are written by the native function', () => {
+      const outWindow = new Gtk.Window({ type: Gtk.WindowType.TOPLEVEL });
+      outWindow.resize(300, 200);
+      expect(outWindow.getSize()).toEqual([300, 200]);
+    });
+
+    test('values passed for out arguments are ignored', () => {
+      const outWindow = new Gtk.Window({ type: Gtk.WindowType.TOPLEVEL });
+      outWindow.resize(300, 200);
+      expect(outWindow.getSize(null, null)).toEqual([300, 200]);
+    });
+
     // test('out arguments', () => {
     //   window.setTitle("Lancelot");
     //   expect(window.getProperty("title")).toEqual("Lancelot");
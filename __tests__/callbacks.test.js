@@ -15,4 +15,27 @@ describe('callbacks', () => {
     task.returnBoolean(true);
     loop.run();
   });
+
+  test('_async methods have a Promise version for their _finish result', async () => {
+    const PRIORITY_DEFAULT = 0;
+    const PRIORITY_LOW = 300;
+    const loop = new GLib.MainLoop(null, false);
+    const stream = Gio.MemoryInputStream.newFromBytes(new GLib.Bytes(Buffer.from('hello')));
+    const promise = stream.readBytesPromise(5, PRIORITY_DEFAULT, null);
+    // the Promise's reactions can't run inside loop.run() so the loop is quit from a
+    // lower priority source, which runs once the read has completed.
+    GLib.idleAdd(PRIORITY_LOW, () => {
+      loop.quit();
+      return false;
+    });
+    loop.run();
+    const bytes = await promise;
+    expect(Buffer.from(bytes.getData()).toString()).toEqual('hello');
+  });
+
+  test('_async methods keep their callback form and the Promise versions check their instance', () => {
+    expect(typeof Gio.InputStream.prototype.readBytesAsync).toBe('function');
+    expect(() => Gio.InputStream.prototype.readBytesPromise.call({}, 5, 0, null)).toThrow(TypeError);
+    expect(() => Gio.InputStream.prototype.readBytesAsync.promise({}, 5, 0, null)).toThrow(TypeError);
+  });
 });
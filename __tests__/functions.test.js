@@ -1,5 +1,6 @@
 const { load, Gtk } = require('../');
 
+const GLib = load('GLib');
 const GObject = load('GObject');
 const GdkPixbuf = load('GdkPixbuf');
 const GIRepository = load('GIRepository');
@@ -21,6 +22,83 @@ describe('functions', () => {
     });
   });
 
+  describe('functions can take arrays', () => {
+    const md5OfHello = '5d41402abc4b2a76b9719d911017c592';
+
+    test('Buffers and TypedArrays are passed as C arrays', () => {
+      expect(GLib.computeChecksumForData(GLib.ChecksumType.MD5, Buffer.from('hello'))).toEqual(md5OfHello);
+      const bytes = new Uint8Array([104, 101, 108, 108, 111]);
+      expect(GLib.computeChecksumForData(GLib.ChecksumType.MD5, bytes)).toEqual(md5OfHello);
+    });
+
+    test('JS arrays are converted to C arrays', () => {
+      expect(GLib.computeChecksumForData(GLib.ChecksumType.MD5, [104, 101, 108, 108, 111])).toEqual(md5OfHello);
+    });
+
+    test('arrays of strings are passed as a GStrv', () => {
+      expect(GLib.strvLength(['a', 'b', 'ünïcödé'])).toEqual(3);
+    });
+
+    test('a GStrv is returned as an array of strings', () => {
+      const dirs = GLib.getSystemDataDirs();
+      expect(Array.isArray(dirs)).toBe(true);
+      dirs.forEach(dir => expect(typeof dir).toEqual('string'));
+    });
+  });
+
+  describe('functions can be called asynchronously', () => {
+    test('fn.async() resolves with the return value', async () => {
+      const [ok, contents] = await GLib.fileGetContents.async(__filename);
+      expect(ok).toBe(true);
+      expect(Buffer.from(contents).toString()).toContain('fileGetContents');
+    });
+
+    test('fn.async() rejects when the native function fails', async () => {
+      await expect(GLib.fileGetContents.async('/this/file/does/not/exist')).rejects.toThrow();
+    });
+
+    test('fn.async() rejects functions that take callbacks', async () => {
+      await expect(GLib.idleAdd.async(GLib.PRIORITY_DEFAULT, () => false)).rejects.toThrow();
+    });
+  });
+
+  describe('functions can be called in batches', () => {
+    test('fn.callMany() calls the function with every argument array', () => {
+      expect(GLib.pathGetBasename.callMany([['/a/b'], ['/c/d']])).toEqual(['b', 'd']);
+    });
+
+    test('fn.callMany() takes TypedArray columns and returns numbers as a TypedArray', () => {
+      const results = GLib.unicharToupper.callMany([new Uint32Array([97, 98, 99])]);
+      expect(results).toEqual(new Uint32Array([65, 66, 67]));
+    });
+
+    test('fn.callMany() rejects columns of different lengths', () => {
+      expect(() => GLib.unicharToupper.callMany([new Uint32Array(2), [1]])).toThrow();
+    });
+
+    test('fn.parallel() resolves with the result of every call', async () => {
+      const results = await GLib.pathGetBasename.parallel([['/a/b'], ['/c/d'], ['/e/f']], { threadSafe: true });
+      expect(results).toEqual(['b', 'd', 'f']);
+    });
+
+    test('fn.parallel() requires the threadSafe opt-in', () => {
+      expect(() => GLib.pathGetBasename.parallel([['/a/b']])).toThrow(TypeError);
+    });
+  });
+
+  describe('functions can be wrapped in JS', () => {
+    const WrappedGLib = load('GLib', { jsWrappers: true });
+
+    test('wrapped functions return the same values', () => {
+      expect(WrappedGLib.spacedPrimesClosest(10)).toEqual(GLib.spacedPrimesClosest(10));
+      expect(WrappedGLib.spacedPrimesClosest.name).toEqual('spacedPrimesClosest');
+    });
+
+    test('wrapped functions keep their entry points', async () => {
+      expect(await WrappedGLib.spacedPrimesClosest.async(10)).toEqual(GLib.spacedPrimesClosest(10));
+    });
+  });
+
   describe('functions can return values', () => {
     test('functions can return a: number', () => {
       const intValue = GObject.typeFromName('GtkWindow');
@@ -52,6 +130,27 @@ describe('functions', () => {
       expect(typeof window.icon).toEqual('object');
     });
 
+    test('functions can return a: list', () => {
+      const box = new Gtk.Box();
+      const first = new Gtk.Label();
+      box.add(first);
+      box.add(new Gtk.Label());
+      const [child] = box.getChildren();
+      expect(child).toBe(first);
+      const children = box.getChildren().toArray();
+      expect(children.length).toEqual(2);
+      const list = box.getChildren();
+      expect(() => list.next.call({})).toThrow(TypeError);
+      expect(() => list.toArray.call({})).toThrow(TypeError);
+    });
+
+    test('functions can return a: hash table', () => {
+      const params = GLib.uriParseParams('a=1&b=2', -1, '&', GLib.UriParamsFlags.NONE);
+      expect(params).toBeInstanceOf(Map);
+      expect(params.get('a')).toEqual('1');
+      expect(params.get('b')).toEqual('2');
+    });
+
     test('void functions return undefined', () => {
       const window = new Gtk.Window();
       const voidValue = window.resize(10, 10);
@@ -81,6 +180,12 @@ describe('functions', () => {
       });
     });
 
+    test('functions can return length annotated arrays as TypedArrays', () => {
+      const decoded = GLib.base64Decode('aGVsbG8=');
+      expect(decoded).toBeInstanceOf(Uint8Array);
+      expect(Buffer.from(decoded).toString()).toEqual('hello');
+    });
+
     test('functions with out arguments should return an array', () => {
       const button = new Gtk.Button();
       const result = button.getPreferredSize();
@@ -94,5 +199,10 @@ describe('functions', () => {
       const window = new Gtk.Window();
       expect(() => window.setTitle(['an', 'array'])).toThrow();
     });
+
+    test('TypeError is thrown when a method is called on something else', () => {
+      expect(() => Gtk.Widget.prototype.show.call({})).toThrow(TypeError);
+      expect(() => Gtk.Widget.prototype.show.call(new GLib.Variant('s', 'text'))).toThrow(TypeError);
+    });
   });
 });
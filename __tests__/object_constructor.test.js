@@ -1,4 +1,7 @@
-const { Gtk } = require('../');
+const { load, Gtk } = require('../');
+
+const GObject = load('GObject');
+const Gio = load('Gio');
 
 describe('Object constructor', () => {
   describe('with "new" operator', () => {
@@ -11,5 +14,35 @@ describe('Object constructor', () => {
       const label = new Gtk.Label({ label: 'aText99' });
       expect(label.label).toEqual('aText99');
     });
+
+    it('returns the same wrapper when the object comes back from native code', () => {
+      const box = new Gtk.Box();
+      const label = new Gtk.Label();
+      box.add(label);
+      expect(label.getParent()).toBe(box);
+    });
+
+    it('wraps objects from native code with their actual class', () => {
+      const button = new Gtk.Button({ label: 'aText99' });
+      expect(button.getChild()).toBeInstanceOf(Gtk.Label);
+    });
+
+    it('wraps interface values (transfer full) as objects', () => {
+      const file = Gio.Vfs.getLocal().getFileForPath('/tmp');
+      expect(file).toBeInstanceOf(GObject.Object);
+    });
+
+    // needs node's --expose-gc flag (see the test script in package.json)
+    const itWithGc = global.gc ? it : it.skip;
+    itWithGc('keeps the wrapper (and it\'s JS properties) alive while native code holds the object', () => {
+      const box = new Gtk.Box();
+      (() => {
+        const label = new Gtk.Label();
+        label.tag = 'kept';
+        box.add(label);
+      })();
+      global.gc();
+      expect(box.getChildren().toArray()[0].tag).toEqual('kept');
+    });
   });
 });
@@ -1,5 +1,6 @@
 const { load, Gtk } = require('../');
 
+const Gdk = load('Gdk');
 const GdkPixbuf = load('GdkPixbuf');
 
 const pixbuf = new GdkPixbuf.Pixbuf();
@@ -70,5 +71,35 @@ describe('Gtk.Object', () => {
         expect(win.icon).not.toBe(win);
       });
     });
+
+    describe('accessors', () => {
+      it('inherited properties are found through the prototype chain', () => {
+        win['width-request'] = 10;
+        expect(win.width_request).toEqual(10);
+        expect(Object.prototype.hasOwnProperty.call(win, 'width_request')).toBe(false);
+      });
+
+      it('other properties are set on the instance', () => {
+        win.notAProperty = 1;
+        expect(win.notAProperty).toEqual(1);
+        expect(new Gtk.Window().notAProperty).toBeUndefined();
+      });
+
+      it('properties of implemented interfaces are accessible', () => {
+        const box = new Gtk.Box({ orientation: Gtk.Orientation.VERTICAL });
+        expect(box.orientation).toEqual(Gtk.Orientation.VERTICAL);
+      });
+
+      it('constructor properties can use underscored names', () => {
+        const window = new Gtk.Window({ default_height: 5 });
+        expect(window['default-height']).toEqual(5);
+      });
+
+      it('are undefined on objects that aren\'t GObject wrappers', () => {
+        const rectangle = new Gdk.Rectangle({ width: 1, height: 1 });
+        Object.setPrototypeOf(rectangle, Gtk.Window.prototype);
+        expect(rectangle.title).toBeUndefined();
+      });
+    });
   });
 });
@@ -0,0 +1,26 @@
+const { load, staticBindings } = require('../src/addon');
+
+// the static addon is only built for GLib by `npm run build:static`
+const binding = staticBindings && staticBindings.GLib;
+const describeIfBuilt = binding ? describe : describe.skip;
+
+describeIfBuilt('static bindings', () => {
+  it('replace the introspected functions and keep their entry points', () => {
+    const GLib = load('GLib');
+    expect(GLib.spacedPrimesClosest.isStatic).toBe(true);
+    expect(GLib.spacedPrimesClosest(10)).toEqual(11);
+    expect(GLib.unicharIsdigit('7'.charCodeAt(0))).toBe(true);
+    expect(typeof GLib.spacedPrimesClosest.async).toEqual('function');
+  });
+
+  it('are never modified by load', () => {
+    load('GLib');
+    load('GLib');
+    expect(Object.keys(binding.functions.spacedPrimesClosest)).toEqual([]);
+  });
+
+  it('aren\'t used when jsWrappers is set', () => {
+    const GLib = load('GLib', { jsWrappers: true });
+    expect(GLib.spacedPrimesClosest.isStatic).toBeUndefined();
+  });
+});
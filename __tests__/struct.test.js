@@ -44,6 +44,14 @@ describe('struct', () => {
     expect(info.getName()).toEqual('Button');
   });
 
+  test('can be returned from native functions that transfer ownership', () => {
+    const rgba = new Gdk.RGBA();
+    rgba.parse('#ff0000');
+    const copy = rgba.copy();
+    expect(copy.red).toEqual(1);
+    expect(copy.green).toEqual(0);
+  });
+
   test('can call functions with structs', () => {
     const info = repo.findByName('Gtk', 'Button');
     const parentInfo = GIRepository.objectInfoGetParent(info);
@@ -64,6 +72,19 @@ describe('struct', () => {
     expect(typeof (typeTagName)).toEqual('string');
   });
 
+  test('methods can return views over the struct\'s memory', () => {
+    const bytes = new GLib.Bytes(Buffer.from('hello'));
+    const view = bytes.getData.view(bytes);
+    expect(view.toString()).toEqual('hello');
+  });
+
+  test('method entry points reject instances of the wrong type', () => {
+    const bytes = new GLib.Bytes(Buffer.from('hello'));
+    expect(() => bytes.getData.view({})).toThrow(TypeError);
+    expect(() => bytes.getData.view(new GLib.Variant('s', 'hello'))).toThrow(TypeError);
+    expect(() => bytes.getData.callMany([[{}]])).toThrow();
+  });
+
   test('"a instanceof b" (and vice versa) should be true for different instances of the same struct', () => {
     const structA = repo.findByName('Gtk', 'Button');
     const structB = repo.findByName('Gtk', 'Button');
@@ -0,0 +1,36 @@
+const { load } = require('../');
+
+const GLib = load('GLib');
+
+describe('variant', () => {
+  test('can be built from a type string and unpacked', () => {
+    const variant = new GLib.Variant('(sib)', ['hello', 42, true]);
+    expect(variant.getTypeString()).toEqual('(sib)');
+    expect(variant.unpack()).toEqual(['hello', 42, true]);
+  });
+
+  test('dictionaries are unpacked as Maps', () => {
+    const variant = new GLib.Variant('a{sv}', { name: 'node-gir', count: 3 });
+    const unpacked = variant.unpack();
+    expect(unpacked).toBeInstanceOf(Map);
+    expect(unpacked.get('name')).toEqual('node-gir');
+    expect(unpacked.get('count')).toEqual(3);
+  });
+
+  test('arrays of numbers are unpacked as TypedArrays', () => {
+    const bytes = new GLib.Variant('ay', Buffer.from('hello'));
+    expect(bytes.unpack()).toBeInstanceOf(Uint8Array);
+    expect(Buffer.from(bytes.unpack()).toString()).toEqual('hello');
+
+    const doubles = new GLib.Variant('ad', [1.5, 2.5]);
+    expect(doubles.unpack()).toEqual(new Float64Array([1.5, 2.5]));
+  });
+
+  test('invalid type strings throw', () => {
+    expect(() => new GLib.Variant('not a type', 1)).toThrow();
+  });
+
+  test('unpack() throws a TypeError on anything but a variant', () => {
+    expect(() => GLib.Variant.prototype.unpack.call({})).toThrow(TypeError);
+  });
+});
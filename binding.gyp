@@ -1,4 +1,10 @@
 {
+    'variables': {
+        # the namespaces to generate static bindings for (see src/generator/static_bindings.cpp)
+        # i.e. node-gyp configure -- -Dstatic_namespaces="GLib Gio GObject"
+        'static_namespaces%': '',
+        'static_libraries%': 'glib-2.0 gobject-2.0 gio-2.0',
+    },
     'targets': [
         {
             'target_name': 'girepository',
@@ -7,22 +13,27 @@
                 'src/util.cpp',
                 'src/namespace_loader.cpp',
                 'src/arguments.cpp',
+                'src/call_plan.cpp',
                 'src/values.cpp',
                 'src/types/object.cpp',
                 'src/types/struct.cpp',
                 'src/types/function.cpp',
                 'src/types/enum.cpp',
                 'src/types/param_spec.cpp',
+                'src/types/list.cpp',
+                'src/types/variant.cpp',
                 'src/loop.cpp',
                 'src/closure.cpp',
+                'src/async_call.cpp',
+                'src/trampolines.cpp',
             ],
             'include_dirs': [
                 '<!(node -e "require(\'nan\')")',
-                '<!@(pkg-config glib-2.0 gobject-introspection-1.0 --cflags-only-I | sed s/-I//g)',
+                '<!@(pkg-config glib-2.0 gobject-introspection-1.0 libffi --cflags-only-I | sed s/-I//g)',
                 'src'
             ],
             'libraries': [
-                '<!@(pkg-config --libs glib-2.0 gobject-introspection-1.0)'
+                '<!@(pkg-config --libs glib-2.0 gobject-introspection-1.0 libffi)'
             ],
             'cflags': [
                 '-std=c++11',
@@ -43,5 +54,66 @@
                 }]
             ]
         }
+    ],
+    'conditions': [
+        ['static_namespaces!=""', {
+            'targets': [
+                {
+                    'target_name': 'generate_static_bindings',
+                    'type': 'executable',
+                    # util.cpp gives the bindings the same JS names as the introspected functions
+                    'sources': [
+                        'src/generator/static_bindings.cpp',
+                        'src/util.cpp',
+                    ],
+                    'include_dirs': [
+                        '<!@(pkg-config glib-2.0 gobject-introspection-1.0 --cflags-only-I | sed s/-I//g)',
+                        'src'
+                    ],
+                    'libraries': [
+                        '<!@(pkg-config --libs glib-2.0 gobject-introspection-1.0)'
+                    ],
+                    'cflags': [
+                        '-std=c++11',
+                        '-fexceptions'
+                    ],
+                    'cflags_cc!': [
+                        '-fno-exceptions'
+                    ]
+                },
+                {
+                    'target_name': 'girepository_static',
+                    'dependencies': [
+                        'generate_static_bindings'
+                    ],
+                    'actions': [
+                        {
+                            'action_name': 'generate_static_bindings_source',
+                            'inputs': [
+                                '<(PRODUCT_DIR)/generate_static_bindings'
+                            ],
+                            'outputs': [
+                                '<(INTERMEDIATE_DIR)/static_bindings.cpp'
+                            ],
+                            'action': [
+                                '<(PRODUCT_DIR)/generate_static_bindings',
+                                '<(INTERMEDIATE_DIR)/static_bindings.cpp',
+                                '<@(static_namespaces)'
+                            ],
+                            'process_outputs_as_sources': 1
+                        }
+                    ],
+                    'include_dirs': [
+                        '<!(node -e "require(\'nan\')")'
+                    ],
+                    'libraries': [
+                        '<!@(pkg-config --libs <(static_libraries))'
+                    ],
+                    'cflags': [
+                        '-std=c++11'
+                    ]
+                }
+            ]
+        }]
     ]
 }
@@ -1,15 +1,66 @@
+function requireBuild(name) {
+  try {
+    // attempt to load the native module from a debug build first
+    // eslint-disable-next-line import/no-dynamic-require, global-require
+    return require(`../build/Debug/${name}`);
+  } catch (error) {
+    if (error.code !== 'MODULE_NOT_FOUND') {
+      throw error;
+    }
+  }
+  // if the debug build couldn't be found, then attempt
+  // to load the release build.
+  // eslint-disable-next-line import/no-dynamic-require, global-require
+  return require(`../build/Release/${name}`);
+}
+
+// don't catch errors for any require() failures on the
+// main module, we should fail fast!
+const girepository = requireBuild('girepository');
+
+// the static bindings are optional, they're only built when
+// binding.gyp's static_namespaces variable is set.
+let staticBindings = null;
 try {
-  // attempt to load the native module from a debug build first
-  // eslint-disable-next-line import/no-unresolved
-  module.exports = require('../build/Debug/girepository');
+  staticBindings = requireBuild('girepository_static');
 } catch (error) {
   if (error.code !== 'MODULE_NOT_FOUND') {
     throw error;
   }
-  // if the debug build couldn't be found, then attempt
-  // to load the release build.
-  // don't catch errors for any require() failures on the
-  // release build, we should fail fast!
-  // eslint-disable-next-line import/no-unresolved
-  module.exports = require('../build/Release/girepository');
 }
+
+// a new function that calls the static function and carries the introspected
+// function's entry points (i.e. fn.async). The static function is shared by every
+// load() so it's never modified. fn.isStatic tells the two kinds of function apart.
+function wrapStaticFunction(staticFunction, introspectedFunction) {
+  function wrapper(...args) {
+    return staticFunction.apply(this, args);
+  }
+  Object.assign(wrapper, introspectedFunction);
+  return Object.defineProperty(wrapper, 'isStatic', { value: true });
+}
+
+/**
+ * loads a namespace, preferring the functions of the static bindings (if they
+ * were built for the namespace and version) over the introspected ones.
+ * the static functions are skipped when the jsWrappers option is set, as they
+ * don't check their arguments the way the generated wrappers do.
+ */
+function load(namespace, ...args) {
+  const exports = girepository.load(namespace, ...args);
+  const binding = staticBindings && staticBindings[namespace];
+  const version = typeof args[0] === 'string' ? args[0] : undefined;
+  const lastArg = args[args.length - 1];
+  const options = lastArg !== null && typeof lastArg === 'object' ? lastArg : {};
+  if (!exports || !binding || (version !== undefined && version !== binding.version) || options.jsWrappers) {
+    return exports;
+  }
+  Object.keys(binding.functions).forEach((name) => {
+    if (typeof exports[name] === 'function') {
+      exports[name] = wrapStaticFunction(binding.functions[name], exports[name]);
+    }
+  });
+  return exports;
+}
+
+module.exports = Object.assign({}, girepository, { load, staticBindings });
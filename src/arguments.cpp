@@ -6,6 +6,7 @@
 #include <vector>
 #include "closure.h"
 #include "exceptions.h"
+#include "types/list.h"
 #include "types/object.h"
 #include "types/struct.h"
 
@@ -13,8 +14,17 @@ using namespace v8;
 
 namespace gir {
 
-Args::Args(GICallableInfo *callable_info) : callable_info(callable_info) {
-    g_base_info_ref(callable_info); // because we keep a reference to the info we need to tell glib
+// unsets a GValue that lives in an Arena. Caller-allocated out GValues
+// may never have been initialized by the native function.
+static void unset_arena_value(gpointer value) {
+    if (G_IS_VALUE(value)) {
+        g_value_unset(static_cast<GValue *>(value));
+    }
+}
+
+Args::Args(const CallPlan &plan) : plan(plan) {
+    this->in.resize(plan.n_in + (plan.is_method ? 1 : 0));
+    this->out.resize(plan.n_out);
 }
 
 /**
@@ -24,39 +34,93 @@ Args::Args(GICallableInfo *callable_info) : callable_info(callable_info) {
  * native "out" arguments even though they aren't passed in via JS function
  * calls.
  * @param js_callback_info is a JS function call info object
+ * @param js_offset is the position of the first JS argument that maps to a native argument
  */
-void Args::load_js_arguments(const Nan::FunctionCallbackInfo<v8::Value> &js_callback_info) {
-    // get the number of arguments the native function requires
-    guint8 gi_argc = g_callable_info_get_n_args(this->callable_info.get());
-
+void Args::load_js_arguments(const Nan::FunctionCallbackInfo<v8::Value> &js_callback_info, int js_offset) {
     // for every expected native argument, we'll take a given JS argument and
-    // convert it into a GIArgument, adding it to the in/out args array depending
-    // on it's direction.
-    for (guint8 i = 0; i < gi_argc; i++) {
-        GIArgInfo argument_info;
-        g_callable_info_load_arg(this->callable_info.get(), i, &argument_info);
-        GIDirection argument_direction = g_arg_info_get_direction(&argument_info);
+    // convert it into a GIArgument, putting it into it's slot in the in/out
+    // args array depending on it's direction.
+    // the lengths of IN arrays aren't passed from JS (their js_index is -1),
+    // they're set when we convert the array.
+    for (const ArgumentPlan &argument : this->plan.arguments) {
+        Local<Value> js_value;
+        if (argument.js_index >= 0) {
+            js_value = js_callback_info[js_offset + argument.js_index];
+        }
+        this->load_argument(argument, js_value);
+    }
+}
 
-        if (argument_direction == GI_DIRECTION_IN) {
-            GIArgument argument = Args::arg_to_g_type(argument_info, js_callback_info[i]);
-            this->in.push_back(argument);
+/**
+ * Like load_js_arguments above but the JS arguments come from an array of values
+ * (i.e. one row of a fn.callMany batch). Missing values are undefined. If a value
+ * is an empty handle then the argument is skipped and the caller fills in it's
+ * slot in Args::in itself.
+ */
+void Args::load_js_arguments(const Local<Value> *js_values, int n_js_values) {
+    for (const ArgumentPlan &argument : this->plan.arguments) {
+        Local<Value> js_value;
+        if (argument.js_index >= 0) {
+            if (argument.js_index >= n_js_values) {
+                js_value = Nan::Undefined();
+            } else if (js_values[argument.js_index].IsEmpty()) {
+                continue;
+            } else {
+                js_value = js_values[argument.js_index];
+            }
         }
+        this->load_argument(argument, js_value);
+    }
+}
 
-        if (argument_direction == GI_DIRECTION_OUT) {
-            GIArgument argument = this->get_out_argument_value(argument_info);
-            this->out.push_back(argument);
+/**
+ * converts a single JS argument into it's slot in the in/out args.
+ * OUT arguments are prepared here too (js_value isn't used for them).
+ */
+void Args::load_argument(const ArgumentPlan &argument, Local<Value> js_value) {
+    // IN arguments come after 'this' (if there is one)
+    int in_offset = this->plan.is_method ? 1 : 0;
+    size_t array_length = 0;
+
+    if (argument.direction == GI_DIRECTION_IN && argument.js_index >= 0) {
+        this->in[in_offset + argument.in_index] = Args::arg_to_g_type(argument,
+                                                                      js_value,
+                                                                      &this->arena,
+                                                                      &array_length);
+        if (argument.array_length_index >= 0) {
+            this->set_array_length(argument.array_length_index, array_length);
         }
+    }
+
+    if (argument.direction == GI_DIRECTION_OUT) {
+        this->out[argument.out_index] = this->get_out_argument_value(argument);
+    }
 
-        if (argument_direction == GI_DIRECTION_INOUT) {
-            GIArgument argument = Args::arg_to_g_type(argument_info, js_callback_info[i]);
-            this->in.push_back(argument);
+    if (argument.direction == GI_DIRECTION_INOUT && argument.js_index >= 0) {
+        GIArgument argument_value = Args::arg_to_g_type(argument, js_value, &this->arena, &array_length);
+        this->in[in_offset + argument.in_index] = argument_value;
+
+        // TODO: is it correct to handle INOUT arguments like IN args?
+        // do we need to handle callee (native) allocates or empty input
+        // GIArguments like we do with OUT args? i'm just assuming this is how it
+        // should work (treating it like an IN arg). Hopfully I can find some
+        // examples to make some test cases asserting the correct behaviour
+        this->out[argument.out_index] = argument_value;
+        if (argument.array_length_index >= 0) {
+            this->set_array_length(argument.array_length_index, array_length);
+        }
+    }
+}
 
-            // TODO: is it correct to handle INOUT arguments like IN args?
-            // do we need to handle callee (native) allocates or empty input
-            // GIArguments like we do with OUT args? i'm just assuming this is how it
-            // should work (treating it like an IN arg). Hopfully I can find some
-            // examples to make some test cases asserting the correct behaviour
-            this->out.push_back(argument);
+/**
+ * Prepares the OUT arguments of a call whose IN arguments don't come from JS
+ * (i.e. a GIO _finish function called from native code). The caller sets the
+ * values of Args::in itself.
+ */
+void Args::load_out_arguments() {
+    for (const ArgumentPlan &argument : this->plan.arguments) {
+        if (argument.direction == GI_DIRECTION_OUT) {
+            this->out[argument.out_index] = this->get_out_argument_value(argument);
         }
     }
 }
@@ -64,67 +128,139 @@ void Args::load_js_arguments(const Nan::FunctionCallbackInfo<v8::Value> &js_call
 /**
  * This function loads the context (i.e. this value of `this`) into the native call arguments.
  * By convention, the context value (a GIRObject in JS or a GObject in native) is put at the
- * start (position 0) of the function call's "in" arguments.
+ * start (position 0) of the function call's "in" arguments. The slot is reserved when Args
+ * is created so nothing needs to be moved.
  */
 void Args::load_context(GObject *this_object) {
-    GIArgument this_object_argument = {
-        .v_pointer = this_object,
-    };
-    this->in.insert(this->in.begin(), this_object_argument);
+    this->in[0].v_pointer = this_object;
+}
+
+/**
+ * Clears the arguments and releases the temporaries of the last call so that
+ * the same Args can be loaded again for another call of the same function.
+ */
+void Args::reset() {
+    this->arena.release();
+    for (size_t i = 0; i < this->in.size(); i++) {
+        this->in[i] = {};
+    }
+    for (size_t i = 0; i < this->out.size(); i++) {
+        this->out[i] = {};
+    }
+}
+
+/**
+ * Returns the value of the argument that holds an array's length (see
+ * ArgumentPlan::array_length_index) or -1 if there isn't one. OUT lengths
+ * are only known after the native function has been called.
+ */
+int Args::get_array_length(int array_length_index) {
+    if (array_length_index < 0 || array_length_index >= (int)this->plan.arguments.size()) {
+        return -1;
+    }
+    const ArgumentPlan &length_argument = this->plan.arguments[array_length_index];
+    GIArgument *length_value;
+    if (length_argument.out_index >= 0) {
+        length_value = &this->out[length_argument.out_index];
+    } else {
+        length_value = &this->in[(this->plan.is_method ? 1 : 0) + length_argument.in_index];
+    }
+
+    switch (Args::map_g_type_tag(length_argument.type_tag)) {
+        case GI_TYPE_TAG_INT8:
+            return length_value->v_int8;
+        case GI_TYPE_TAG_UINT8:
+            return length_value->v_uint8;
+        case GI_TYPE_TAG_INT16:
+            return length_value->v_int16;
+        case GI_TYPE_TAG_UINT16:
+            return length_value->v_uint16;
+        case GI_TYPE_TAG_INT32:
+            return length_value->v_int32;
+        case GI_TYPE_TAG_UINT32:
+            return length_value->v_uint32;
+        case GI_TYPE_TAG_INT64:
+            return length_value->v_int64;
+        case GI_TYPE_TAG_UINT64:
+            return length_value->v_uint64;
+        default:
+            return -1;
+    }
+}
+
+/**
+ * Sets the value of the argument that holds an IN array's length.
+ */
+void Args::set_array_length(int array_length_index, size_t length) {
+    if (array_length_index < 0 || array_length_index >= (int)this->plan.arguments.size()) {
+        return;
+    }
+    const ArgumentPlan &length_argument = this->plan.arguments[array_length_index];
+    GIArgument length_value;
+    switch (Args::map_g_type_tag(length_argument.type_tag)) {
+        case GI_TYPE_TAG_INT8:
+            length_value.v_int8 = length;
+            break;
+        case GI_TYPE_TAG_UINT8:
+            length_value.v_uint8 = length;
+            break;
+        case GI_TYPE_TAG_INT16:
+            length_value.v_int16 = length;
+            break;
+        case GI_TYPE_TAG_UINT16:
+            length_value.v_uint16 = length;
+            break;
+        case GI_TYPE_TAG_INT32:
+            length_value.v_int32 = length;
+            break;
+        case GI_TYPE_TAG_UINT32:
+            length_value.v_uint32 = length;
+            break;
+        case GI_TYPE_TAG_INT64:
+            length_value.v_int64 = length;
+            break;
+        case GI_TYPE_TAG_UINT64:
+            length_value.v_uint64 = length;
+            break;
+        default:
+            throw UnsupportedGIType("array length arguments must be integers");
+    }
+    if (length_argument.in_index >= 0) {
+        this->in[(this->plan.is_method ? 1 : 0) + length_argument.in_index] = length_value;
+    }
+    if (length_argument.out_index >= 0) {
+        this->out[length_argument.out_index] = length_value;
+    }
 }
 
-GIArgument Args::get_out_argument_value(GIArgInfo &argument_info) {
-    GITypeInfo argument_type_info;
-    g_arg_info_load_type(&argument_info, &argument_type_info);
-    if (g_arg_info_is_caller_allocates(&argument_info)) {
-        GITypeTag arg_type_tag = g_type_info_get_tag(&argument_type_info);
+GIArgument Args::get_out_argument_value(const ArgumentPlan &argument) {
+    if (argument.caller_allocates) {
         // If the caller is responsible for allocating the out arguments memeory
-        // then we'll have to look up the argument's type infomation and allocate
-        // a slice of memory for the GIArgument's .v_pointer (native function will
-        // fill it up)
-        if (arg_type_tag == GI_TYPE_TAG_INTERFACE) {
-            GIRInfoUniquePtr argument_interface_info = GIRInfoUniquePtr(g_type_info_get_interface(&argument_type_info));
-            GIInfoType argument_interface_type = g_base_info_get_type(argument_interface_info.get());
-            gsize argument_size;
-
-            if (argument_interface_type == GI_INFO_TYPE_STRUCT) {
-                argument_size = g_struct_info_get_size((GIStructInfo *)argument_interface_info.get());
-            } else if (argument_interface_type == GI_INFO_TYPE_UNION) {
-                argument_size = g_union_info_get_size((GIUnionInfo *)argument_interface_info.get());
-            } else {
-                stringstream message;
-                message << "type \"" << g_type_tag_to_string(arg_type_tag) << "\" for out caller-allocates";
+        // then we'll have to allocate a slice of memory for the GIArgument's
+        // .v_pointer (native function will fill it up). The CallPlan has already
+        // worked out how big the struct or union is.
+        if (argument.caller_allocates_size == 0) {
+            stringstream message;
+            message << "type \"" << g_type_tag_to_string(argument.type_tag) << "\" for out caller-allocates";
+            if (argument.type_tag == GI_TYPE_TAG_INTERFACE) {
                 message << " Expected a struct or union.";
-                throw UnsupportedGIType(message.str());
             }
-
-            GIArgument argument;
-            // FIXME: who deallocates?
-            // I imagine the original function caller (in JS land) will need
-            // to use the structure that the native function puts into this
-            // slice of memory, meaning we can't deallocate when Args is destroyed.
-            // Perhaps we should research into GJS and PyGObject to understand
-            // the problem of "out arguments with caller allocation" better.
-            // Some thoughts:
-            // 1. if the data is **copied** into a gir object/struct when passed back
-            //    to JS then we can safely implement a custom deleter for Args.out
-            //    that cleans this up.
-            // 2. if the pointer to the data is passed to a gir object/struct when
-            //    passed back to JS then that JS object should own it and be
-            //    responsible for cleaning it up.
-            // * both choices have caveats so it's worth understanding the
-            // implications
-            //   of each, or other options to solve this leak!
-            // * from reading GJS code, it seems like they copy the data before
-            // passing
-            // * to JS meaning option 1.
-            argument.v_pointer = g_slice_alloc0(argument_size);
-            return argument;
-        } else {
-            stringstream message;
-            message << "type \"" << g_type_tag_to_string(arg_type_tag) << "\" for out caller-allocates";
             throw UnsupportedGIType(message.str());
         }
+
+        // The memory comes from the call's arena so it's released with Args.
+        // This is safe because GIRStruct::from_existing copies the struct
+        // when it's passed back to JS (the same thing GJS does).
+        GIArgument argument_value;
+        argument_value.v_pointer = this->arena.allocate(argument.caller_allocates_size);
+
+        // a caller-allocated GValue is initialized by the native function
+        // so we have to unset it once we've converted it
+        if (argument.interface_type == GI_INFO_TYPE_STRUCT &&
+            g_registered_type_info_get_g_type(argument.interface_info.get()) == G_TYPE_VALUE) {
+            this->arena.add_cleanup(unset_arena_value, argument_value.v_pointer);
+        }
+        return argument_value;
     }
     // else, if we're not responsible for allocation then we can just return an
     // empty GIArgument with a NULL .v_pointer (native call will set it with a
@@ -133,40 +269,78 @@ GIArgument Args::get_out_argument_value(GIArgInfo &argument_info) {
     return argument;
 }
 
-GIArgument Args::arg_to_g_type(GIArgInfo &argument_info, Local<Value> js_value) {
-    GITypeInfo argument_type_info;
-    g_arg_info_load_type(&argument_info, &argument_type_info);
-    GITypeTag argument_type_tag = g_type_info_get_tag(&argument_type_info);
+/**
+ * Converts a JS value into the GIArgument for a native function's IN (or INOUT) argument.
+ * @param arena holds any temporaries the conversion creates. It's ignored when the
+ *        argument is transfer-full because the native function will own (and free) the value.
+ * @param array_length is set to the number of elements when the argument is an array.
+ */
+GIArgument Args::arg_to_g_type(const ArgumentPlan &argument,
+                               Local<Value> js_value,
+                               Arena *arena,
+                               size_t *array_length) {
+    if (array_length != nullptr) {
+        *array_length = 0;
+    }
 
     if (js_value->IsNullOrUndefined()) {
-        if (g_arg_info_may_be_null(&argument_info) || argument_type_tag == GI_TYPE_TAG_VOID) {
+        if (argument.may_be_null || argument.type_tag == GI_TYPE_TAG_VOID) {
             GIArgument argument_value;
             argument_value.v_pointer = nullptr;
             argument_value.v_string = nullptr;
             return argument_value;
         }
         stringstream message;
-        message << "Argument '" << g_base_info_get_name(&argument_info) << "' may not be null or undefined";
+        message << "Argument '" << g_base_info_get_name(&argument.arg_info) << "' may not be null or undefined";
         throw JSArgumentTypeError(message.str());
     }
 
     try {
-        return Args::type_to_g_type(argument_type_info, js_value);
+        if (argument.type_tag == GI_TYPE_TAG_ARRAY) {
+            return Args::array_to_g_type(argument.type_info, js_value, arena, argument.transfer, array_length);
+        }
+        if (argument.transfer == GI_TRANSFER_EVERYTHING) {
+            arena = nullptr;
+        }
+        return Args::type_to_g_type(argument.type_info,
+                                    argument.type_tag,
+                                    argument.interface_info.get(),
+                                    js_value,
+                                    arena);
     } catch (JSArgumentTypeError &error) {
         // we want to nicely format all type errors so we'll catch them and rethrow
         // using a nice message
         Nan::Utf8String js_type_name(js_value->TypeOf(Isolate::GetCurrent()));
         stringstream message;
-        message << "Expected type '" << g_type_tag_to_string(argument_type_tag);
-        message << "' for Argument '" << g_base_info_get_name(&argument_info);
+        message << "Expected type '" << g_type_tag_to_string(argument.type_tag);
+        message << "' for Argument '" << g_base_info_get_name(&argument.arg_info);
         message << "' but got type '" << *js_type_name << "'";
         throw JSArgumentTypeError(message.str());
     }
 }
 
-GIArgument Args::type_to_g_type(GITypeInfo &argument_type_info, Local<Value> js_value) {
+GIArgument Args::type_to_g_type(GITypeInfo &argument_type_info, Local<Value> js_value, Arena *arena) {
     GITypeTag argument_type_tag = g_type_info_get_tag(&argument_type_info);
+    GIRInfoUniquePtr interface_info = nullptr;
+    if (argument_type_tag == GI_TYPE_TAG_INTERFACE) {
+        interface_info = GIRInfoUniquePtr(g_type_info_get_interface(&argument_type_info));
+    }
+    return Args::type_to_g_type(argument_type_info, argument_type_tag, interface_info.get(), js_value, arena);
+}
 
+/**
+ * Converts a JS value into a GIArgument. The type tag and interface info
+ * can be read from argument_type_info but callers that already know them
+ * (i.e. via a CallPlan) can pass them in to avoid reading the GI metadata again.
+ * @param interface_info should be nullptr unless argument_type_tag is GI_TYPE_TAG_INTERFACE
+ * @param arena is where temporary values (strings, GValues) are allocated. If it's
+ *        nullptr then they're allocated with glib and the caller owns them.
+ */
+GIArgument Args::type_to_g_type(GITypeInfo &argument_type_info,
+                                GITypeTag argument_type_tag,
+                                GIBaseInfo *interface_info,
+                                Local<Value> js_value,
+                                Arena *arena) {
     // if the arg type is a GTYPE (which is an integer)
     // then we want to pretend it's a GI_TYPE_TAG_INTX
     // where x is the sizeof the GTYPE. This helper function
@@ -236,24 +410,29 @@ GIArgument Args::type_to_g_type(GITypeInfo &argument_type_info, Local<Value> js_
             if (!js_value->IsString()) {
                 throw JSArgumentTypeError();
             } else {
+                // we have to copy the string because Nan::Utf8String's
+                // buffer doesn't outlive this scope.
                 Nan::Utf8String js_string(js_value->ToString());
-                // FIXME: memory leak as we never g_free(.v_string)
-                // ideally the memory would be freed when the GIArgument
-                // was destroyed. Perhaps we need to use a unique_ptr
-                // with a custom deleter?
-                // I think it's clear that the memory needs to be owned by
-                // the GIArgument (or value ToGType returns) because
-                // we can't expect callers to know they are responsible
-                // for deallocation, and we can't expect to borrow the
-                // memory (if we don't copy the string then tests start
-                // failing with corrupt memory rather than the original strings).
-                argument_value.v_string = strdup(*js_string);
+                if (arena != nullptr) {
+                    argument_value.v_string = arena->copy_string(*js_string, js_string.length());
+                } else {
+                    argument_value.v_string = g_strdup(*js_string);
+                }
             }
             break;
 
+        case GI_TYPE_TAG_ARRAY: {
+            // without an arena the caller owns the array, just like a transfer-full argument
+            GITransfer transfer = arena != nullptr ? GI_TRANSFER_NOTHING : GI_TRANSFER_EVERYTHING;
+            argument_value = Args::array_to_g_type(argument_type_info, js_value, arena, transfer, nullptr);
+        } break;
+
+        case GI_TYPE_TAG_GHASH:
+            argument_value.v_pointer = Args::hash_to_g_type(argument_type_info, js_value, arena);
+            break;
+
         case GI_TYPE_TAG_INTERFACE: {
-            auto interface_info = GIRInfoUniquePtr(g_type_info_get_interface(&argument_type_info));
-            GIInfoType interface_type = g_base_info_get_type(interface_info.get());
+            GIInfoType interface_type = g_base_info_get_type(interface_info);
 
             switch (interface_type) {
                 case GI_INFO_TYPE_OBJECT:
@@ -272,11 +451,19 @@ GIArgument Args::type_to_g_type(GITypeInfo &argument_type_info, Local<Value> js_
                 case GI_INFO_TYPE_STRUCT:
                 case GI_INFO_TYPE_UNION:
                 case GI_INFO_TYPE_BOXED: {
-                    GType g_type = g_registered_type_info_get_g_type(interface_info.get());
+                    GType g_type = g_registered_type_info_get_g_type(interface_info);
                     if (g_type_is_a(g_type, G_TYPE_VALUE)) {
                         GValue gvalue = GIRValue::to_g_value(js_value, g_type);
-                        argument_value.v_pointer = g_boxed_copy(g_type, &gvalue); // FIXME: should we copy? where do
-                                                                                  // we deallocate?
+                        if (arena != nullptr) {
+                            // move the GValue into the arena, it'll be unset when the arena is released
+                            GValue *arena_value = static_cast<GValue *>(arena->allocate(sizeof(GValue)));
+                            *arena_value = gvalue;
+                            arena->add_cleanup(unset_arena_value, arena_value);
+                            argument_value.v_pointer = arena_value;
+                        } else {
+                            argument_value.v_pointer = g_boxed_copy(G_TYPE_VALUE, &gvalue);
+                            g_value_unset(&gvalue);
+                        }
                     } else {
                         GIRStruct *gir_struct = Nan::ObjectWrap::Unwrap<GIRStruct>(js_value->ToObject());
                         argument_value.v_pointer = gir_struct->get_native_ptr();
@@ -290,7 +477,7 @@ GIArgument Args::type_to_g_type(GITypeInfo &argument_type_info, Local<Value> js_
 
                 case GI_INFO_TYPE_CALLBACK:
                     if (js_value->IsFunction()) {
-                        auto closure = GIRClosure::create_ffi(interface_info.get(), js_value.As<Function>());
+                        auto closure = GIRClosure::create_ffi(interface_info, js_value.As<Function>());
                         argument_value.v_pointer = closure;
                     } else {
                         throw JSArgumentTypeError();
@@ -314,47 +501,812 @@ GIArgument Args::type_to_g_type(GITypeInfo &argument_type_info, Local<Value> js_
     return argument_value;
 }
 
-Local<Value> Args::from_g_type_array(GIArgument *arg, GITypeInfo *type, int array_length) {
-    GIArrayType array_type_info = g_type_info_get_array_type(type);
+// copies a native array of numbers into a new TypedArray with a single memcpy.
+// if data is nullptr then the TypedArray is left zero filled.
+template<typename TypedArrayType, typename CType>
+static Local<Value> copy_to_typed_array(gpointer data, size_t length) {
+    Local<ArrayBuffer> buffer = ArrayBuffer::New(Isolate::GetCurrent(), length * sizeof(CType));
+    if (data != nullptr) {
+        memcpy(buffer->GetContents().Data(), data, length * sizeof(CType));
+    }
+    return TypedArrayType::New(buffer, 0, length);
+}
+
+// 64 bit integers can't be stored in a TypedArray (that Node supports) so we
+// convert them to doubles. Like Args::from_g_type this loses precision for
+// values with more than 53 significant bits.
+template<typename CType>
+static Local<Value> convert_to_float64_array(gpointer data, size_t length) {
+    Local<ArrayBuffer> buffer = ArrayBuffer::New(Isolate::GetCurrent(), length * sizeof(double));
+    double *doubles = static_cast<double *>(buffer->GetContents().Data());
+    CType *values = static_cast<CType *>(data);
+    for (size_t i = 0; i < length; i++) {
+        doubles[i] = static_cast<double>(values[i]);
+    }
+    return Float64Array::New(buffer, 0, length);
+}
+
+/**
+ * Converts a native array of numbers into the matching TypedArray.
+ * Returns an empty handle if the element type isn't a number.
+ */
+Local<Value> Args::from_g_type_numeric_array(gpointer data, size_t length, GITypeTag element_tag) {
+    switch (element_tag) {
+        case GI_TYPE_TAG_INT8:
+            return copy_to_typed_array<Int8Array, gint8>(data, length);
+        case GI_TYPE_TAG_UINT8:
+            return copy_to_typed_array<Uint8Array, guint8>(data, length);
+        case GI_TYPE_TAG_INT16:
+            return copy_to_typed_array<Int16Array, gint16>(data, length);
+        case GI_TYPE_TAG_UINT16:
+            return copy_to_typed_array<Uint16Array, guint16>(data, length);
+        case GI_TYPE_TAG_INT32:
+            return copy_to_typed_array<Int32Array, gint32>(data, length);
+        case GI_TYPE_TAG_UINT32:
+        case GI_TYPE_TAG_UNICHAR:
+            return copy_to_typed_array<Uint32Array, guint32>(data, length);
+        case GI_TYPE_TAG_FLOAT:
+            return copy_to_typed_array<Float32Array, gfloat>(data, length);
+        case GI_TYPE_TAG_DOUBLE:
+            return copy_to_typed_array<Float64Array, gdouble>(data, length);
+        case GI_TYPE_TAG_INT64:
+            return convert_to_float64_array<gint64>(data, length);
+        case GI_TYPE_TAG_UINT64:
+            return convert_to_float64_array<guint64>(data, length);
+        case GI_TYPE_TAG_GTYPE:
+            return convert_to_float64_array<GType>(data, length);
+        default:
+            return Local<Value>();
+    }
+}
+
+// what to release when an external ArrayBuffer created by
+// view_numeric_array is freed: either the owner of the memory or the
+// memory itself if it was transferred to us.
+struct ArrayViewRelease {
+    gpointer data;
+    GDestroyNotify release;
+};
+
+static void free_array_view(char *data, void *hint) {
+    ArrayViewRelease *view_release = static_cast<ArrayViewRelease *>(hint);
+    view_release->release(view_release->data);
+    delete view_release;
+}
+
+/**
+ * Exposes a native array of numbers to JS as a TypedArray over an external
+ * ArrayBuffer (no copy). If we own the memory (the transfer isn't 'nothing')
+ * then it's freed with the ArrayBuffer, otherwise the owner of the memory is
+ * kept alive until then. Returns an empty handle if a view can't be created.
+ */
+static Local<Value> view_numeric_array(gpointer data,
+                                       size_t length,
+                                       size_t element_size,
+                                       GITypeTag element_tag,
+                                       GITransfer transfer,
+                                       const ArrayViewOwner *view_owner) {
+    // only types that have a TypedArray can be viewed. There aren't
+    // TypedArrays for 64 bit integers (that Node supports).
+    switch (element_tag) {
+        case GI_TYPE_TAG_INT8:
+        case GI_TYPE_TAG_UINT8:
+        case GI_TYPE_TAG_INT16:
+        case GI_TYPE_TAG_UINT16:
+        case GI_TYPE_TAG_INT32:
+        case GI_TYPE_TAG_UINT32:
+        case GI_TYPE_TAG_UNICHAR:
+        case GI_TYPE_TAG_FLOAT:
+        case GI_TYPE_TAG_DOUBLE:
+            break;
+        default:
+            return Local<Value>();
+    }
+
+    ArrayViewRelease *view_release = new ArrayViewRelease();
+    if (transfer != GI_TRANSFER_NOTHING) {
+        view_release->data = data;
+        view_release->release = g_free;
+    } else if (view_owner->owner != nullptr) {
+        view_release->data = view_owner->ref(view_owner->owner);
+        view_release->release = view_owner->unref;
+    } else {
+        delete view_release;
+        return Local<Value>();
+    }
+
+    size_t byte_length = length * element_size;
+    Local<Object> buffer =
+        Nan::NewBuffer(static_cast<char *>(data), byte_length, free_array_view, view_release).ToLocalChecked();
+    if (element_tag == GI_TYPE_TAG_UINT8) {
+        return buffer;
+    }
+    Local<ArrayBuffer> array_buffer = buffer.As<Uint8Array>()->Buffer();
+    size_t byte_offset = buffer.As<Uint8Array>()->ByteOffset();
+    switch (element_tag) {
+        case GI_TYPE_TAG_INT8:
+            return Int8Array::New(array_buffer, byte_offset, length);
+        case GI_TYPE_TAG_INT16:
+            return Int16Array::New(array_buffer, byte_offset, length);
+        case GI_TYPE_TAG_UINT16:
+            return Uint16Array::New(array_buffer, byte_offset, length);
+        case GI_TYPE_TAG_INT32:
+            return Int32Array::New(array_buffer, byte_offset, length);
+        case GI_TYPE_TAG_UINT32:
+        case GI_TYPE_TAG_UNICHAR:
+            return Uint32Array::New(array_buffer, byte_offset, length);
+        case GI_TYPE_TAG_FLOAT:
+            return Float32Array::New(array_buffer, byte_offset, length);
+        default:
+            return Float64Array::New(array_buffer, byte_offset, length);
+    }
+}
+
+/**
+ * Returns the tag of the type a (non pointer) array element is stored as.
+ * This is the element's tag except for enums and flags which are stored as integers.
+ */
+static GITypeTag get_array_element_storage_tag(GITypeTag element_tag, GIBaseInfo *element_interface_info) {
+    if (element_tag == GI_TYPE_TAG_INTERFACE) {
+        GIInfoType interface_type = g_base_info_get_type(element_interface_info);
+        if (interface_type == GI_INFO_TYPE_ENUM || interface_type == GI_INFO_TYPE_FLAGS) {
+            return g_enum_info_get_storage_type((GIEnumInfo *)element_interface_info);
+        }
+    }
+    return element_tag;
+}
+
+/**
+ * Returns the size of each element of a C array.
+ */
+static size_t get_array_element_size(GITypeInfo *element_type_info,
+                                     GITypeTag element_tag,
+                                     GIBaseInfo *element_interface_info) {
+    if (g_type_info_is_pointer(element_type_info)) {
+        return sizeof(gpointer);
+    }
+    switch (get_array_element_storage_tag(element_tag, element_interface_info)) {
+        case GI_TYPE_TAG_BOOLEAN:
+            return sizeof(gboolean);
+        case GI_TYPE_TAG_INT8:
+        case GI_TYPE_TAG_UINT8:
+            return sizeof(guint8);
+        case GI_TYPE_TAG_INT16:
+        case GI_TYPE_TAG_UINT16:
+            return sizeof(guint16);
+        case GI_TYPE_TAG_INT32:
+        case GI_TYPE_TAG_UINT32:
+        case GI_TYPE_TAG_UNICHAR:
+            return sizeof(guint32);
+        case GI_TYPE_TAG_INT64:
+        case GI_TYPE_TAG_UINT64:
+            return sizeof(guint64);
+        case GI_TYPE_TAG_FLOAT:
+            return sizeof(gfloat);
+        case GI_TYPE_TAG_DOUBLE:
+            return sizeof(gdouble);
+        case GI_TYPE_TAG_GTYPE:
+            return sizeof(GType);
+        case GI_TYPE_TAG_INTERFACE: {
+            // structs and unions can be stored in the array itself
+            GIInfoType interface_type = g_base_info_get_type(element_interface_info);
+            if (interface_type == GI_INFO_TYPE_STRUCT) {
+                return g_struct_info_get_size((GIStructInfo *)element_interface_info);
+            }
+            if (interface_type == GI_INFO_TYPE_UNION) {
+                return g_union_info_get_size((GIUnionInfo *)element_interface_info);
+            }
+            return sizeof(gpointer);
+        }
+        default:
+            return sizeof(gpointer);
+    }
+}
+
+/**
+ * Counts the elements of a zero terminated array, i.e. the elements
+ * before the first element whose bytes are all zero.
+ */
+static size_t get_zero_terminated_length(const guint8 *native_array, size_t element_size) {
+    for (size_t length = 0;; length++) {
+        const guint8 *element = native_array + length * element_size;
+        bool is_zero = true;
+        for (size_t i = 0; i < element_size && is_zero; i++) {
+            is_zero = element[i] == 0;
+        }
+        if (is_zero) {
+            return length;
+        }
+    }
+}
+
+/**
+ * Converts a native array of strings (i.e. a GStrv) into a JS array in one pass.
+ * ASCII strings (the common case for paths, names, etc) are created as one byte
+ * JS strings which skips V8's UTF-8 decoding.
+ */
+static Local<Value> from_g_type_strv(gchar **strv, size_t length, GITransfer transfer) {
+    Local<Array> js_array = Nan::New<Array>(length);
+    for (size_t i = 0; i < length; i++) {
+        const gchar *string = strv[i];
+        if (string == nullptr) {
+            Nan::Set(js_array, i, Nan::Null());
+            continue;
+        }
+
+        bool is_ascii = true;
+        size_t string_length = 0;
+        for (; string[string_length] != '\0'; string_length++) {
+            is_ascii = is_ascii && static_cast<guchar>(string[string_length]) < 0x80;
+        }
+        if (is_ascii) {
+            Nan::Set(js_array,
+                     i,
+                     Nan::NewOneByteString(reinterpret_cast<const uint8_t *>(string), string_length).ToLocalChecked());
+        } else {
+            Nan::Set(js_array, i, Nan::New(string, string_length).ToLocalChecked());
+        }
+
+        if (transfer == GI_TRANSFER_EVERYTHING) {
+            g_free(strv[i]);
+        }
+    }
+    return js_array;
+}
+
+/**
+ * Converts a native C array into a JS value. Arrays of numbers are copied
+ * into a TypedArray in bulk and anything else becomes a JS array.
+ * @param array_length is the number of elements in the array or -1 if it's unknown.
+ *        It's only used if the array isn't zero terminated and doesn't have a fixed size.
+ * @param transfer is the ownership transfer of the array. If we own the array's
+ *        container then it's freed after it's been converted (and the elements
+ *        are freed too if we own those as well).
+ * @param view_owner if it's not nullptr then arrays of numbers are exposed to JS as a view
+ *        over the native memory (see ArrayViewOwner) rather than copied, where possible.
+ */
+Local<Value> Args::from_g_type_array(GIArgument *arg,
+                                     GITypeInfo *type,
+                                     int array_length,
+                                     GITransfer transfer,
+                                     const ArrayViewOwner *view_owner) {
+    if (g_type_info_get_array_type(type) != GI_ARRAY_TYPE_C) {
+        throw UnsupportedGIType("cannot convert native array type");
+    }
+
+    if (arg->v_pointer == nullptr) {
+        return Nan::Null();
+    }
+
     auto element_type_info = GIRInfoUniquePtr(g_type_info_get_param_type(type, 0));
-    GITypeTag param_tag = g_type_info_get_tag(element_type_info.get());
-
-    switch (array_type_info) {
-        case GI_ARRAY_TYPE_C:
-            if (g_type_info_is_zero_terminated(type)) {
-                GIArgument element;
-                gpointer *native_array = (gpointer *)arg->v_pointer;
-                Local<Array> js_array = Nan::New<Array>();
-                for (int i = 0; native_array[i]; i++) {
-                    element.v_pointer = native_array[i];
-                    Local<Value> js_element = Args::from_g_type(&element, element_type_info.get(), 0);
-                    js_array->Set(i, js_element);
-                }
-                return js_array;
+    GITypeTag element_tag = g_type_info_get_tag(element_type_info.get());
+    GIRInfoUniquePtr element_interface_info = nullptr;
+    if (element_tag == GI_TYPE_TAG_INTERFACE) {
+        element_interface_info = GIRInfoUniquePtr(g_type_info_get_interface(element_type_info.get()));
+    }
+    bool is_pointer_array = g_type_info_is_pointer(element_type_info.get());
+    size_t element_size = get_array_element_size(element_type_info.get(), element_tag, element_interface_info.get());
+    guint8 *native_array = static_cast<guint8 *>(arg->v_pointer);
+
+    // work out how many elements are in the array
+    size_t length = 0;
+    if (g_type_info_is_zero_terminated(type)) {
+        length = get_zero_terminated_length(native_array, element_size);
+    } else if (g_type_info_get_array_fixed_size(type) >= 0) {
+        length = g_type_info_get_array_fixed_size(type);
+    } else if (array_length >= 0) {
+        length = array_length;
+    } else {
+        throw UnsupportedGIType("cannot convert a C array without knowing it's length");
+    }
+
+    Local<Value> js_value;
+    if (element_tag == GI_TYPE_TAG_UTF8 || element_tag == GI_TYPE_TAG_FILENAME) {
+        js_value = from_g_type_strv(reinterpret_cast<gchar **>(native_array), length, transfer);
+    } else if (!is_pointer_array) {
+        GITypeTag storage_tag = get_array_element_storage_tag(element_tag, element_interface_info.get());
+        if (view_owner != nullptr) {
+            js_value = view_numeric_array(native_array, length, element_size, storage_tag, transfer, view_owner);
+            if (!js_value.IsEmpty() && transfer != GI_TRANSFER_NOTHING) {
+                // the view owns the memory now
+                return js_value;
+            }
+        }
+        if (js_value.IsEmpty()) {
+            js_value = Args::from_g_type_numeric_array(native_array, length, storage_tag);
+        }
+    }
+
+    if (js_value.IsEmpty()) {
+        // transfer 'container' means we own the array but not it's elements.
+        // structs stored in the array itself belong to the array so they're always copied.
+        bool is_struct_array = !is_pointer_array && element_tag == GI_TYPE_TAG_INTERFACE;
+        GITransfer element_transfer = transfer == GI_TRANSFER_EVERYTHING && !is_struct_array ? GI_TRANSFER_EVERYTHING
+                                                                                              : GI_TRANSFER_NOTHING;
+        Local<Array> js_array = Nan::New<Array>(length);
+        for (size_t i = 0; i < length; i++) {
+            guint8 *native_element = native_array + i * element_size;
+            GIArgument element;
+            if (is_struct_array) {
+                element.v_pointer = native_element;
+            } else {
+                // every GIArgument field starts at the beginning of the union
+                // so we can copy the element straight into it
+                memset(&element, 0, sizeof(element));
+                memcpy(&element, native_element, element_size);
+            }
+            js_array->Set(i,
+                          Args::from_g_type(&element,
+                                            element_type_info.get(),
+                                            element_tag,
+                                            element_interface_info.get(),
+                                            -1,
+                                            element_transfer));
+        }
+        js_value = js_array;
+    }
+
+    if (transfer != GI_TRANSFER_NOTHING) {
+        g_free(native_array);
+    }
+    return js_value;
+}
+
+// returns true if a TypedArray's elements can be passed
+// as-is for native array elements with the given storage tag.
+bool Args::typed_array_matches(Local<Value> typed_array, GITypeTag storage_tag) {
+    switch (storage_tag) {
+        case GI_TYPE_TAG_INT8:
+            return typed_array->IsInt8Array();
+        case GI_TYPE_TAG_UINT8:
+            return typed_array->IsUint8Array() || typed_array->IsUint8ClampedArray();
+        case GI_TYPE_TAG_INT16:
+            return typed_array->IsInt16Array();
+        case GI_TYPE_TAG_UINT16:
+            return typed_array->IsUint16Array();
+        case GI_TYPE_TAG_INT32:
+            return typed_array->IsInt32Array();
+        case GI_TYPE_TAG_UINT32:
+        case GI_TYPE_TAG_UNICHAR:
+            return typed_array->IsUint32Array();
+        case GI_TYPE_TAG_FLOAT:
+            return typed_array->IsFloat32Array();
+        case GI_TYPE_TAG_DOUBLE:
+            return typed_array->IsFloat64Array();
+        default:
+            return false;
+    }
+}
+
+// allocates a native array from the arena or, if there's no
+// arena, with glib so the native function can free it.
+static guint8 *allocate_native_array(Arena *arena, size_t size) {
+    if (arena != nullptr) {
+        return static_cast<guint8 *>(arena->allocate(size));
+    }
+    return static_cast<guint8 *>(g_malloc0(size));
+}
+
+/**
+ * Packs a JS array of strings into a single allocation from the arena: a null
+ * terminated table of pointers followed by the bytes of every string.
+ * Throws a JSArgumentTypeError if an element isn't a string.
+ */
+static gchar **strv_to_g_type(Local<Array> js_array, Arena *arena) {
+    uint32_t length = js_array->Length();
+
+    // measure every string first so we only allocate once. Each element is read
+    // once, a getter could return a different (longer) string the second time.
+    vector<Local<String>> js_strings(length);
+    size_t string_bytes = 0;
+    for (uint32_t i = 0; i < length; i++) {
+        Local<Value> js_element = Nan::Get(js_array, i).ToLocalChecked();
+        if (!js_element->IsString()) {
+            throw JSArgumentTypeError();
+        }
+        js_strings[i] = js_element.As<String>();
+        string_bytes += js_strings[i]->Utf8Length() + 1;
+    }
+
+    size_t table_size = (length + 1) * sizeof(gchar *);
+    guint8 *memory = static_cast<guint8 *>(arena->allocate(table_size + string_bytes));
+    gchar **strv = reinterpret_cast<gchar **>(memory);
+    gchar *cursor = reinterpret_cast<gchar *>(memory + table_size);
+    gchar *end = cursor + string_bytes;
+    for (uint32_t i = 0; i < length; i++) {
+        strv[i] = cursor;
+        // WriteUtf8 returns the number of bytes written including the null terminator
+        cursor += js_strings[i]->WriteUtf8(cursor, static_cast<int>(end - cursor));
+    }
+    strv[length] = nullptr;
+    return strv;
+}
+
+/**
+ * Converts a JS value into a native C array.
+ * ArrayBuffers, Buffers and TypedArrays (with the same element type as the native
+ * array) are passed to the native function as a pointer into their memory without
+ * copying. Other JS arrays (and TypedArrays of a different type) are converted
+ * element by element into a new native array.
+ * @param transfer is the ownership transfer of the array. The native function frees
+ *        arrays that are transferred to it, so those are always copied and aren't
+ *        allocated from the arena.
+ * @param array_length is set to the number of elements in the array (if it's not nullptr)
+ */
+GIArgument Args::array_to_g_type(GITypeInfo &array_type_info,
+                                 Local<Value> js_value,
+                                 Arena *arena,
+                                 GITransfer transfer,
+                                 size_t *array_length) {
+    if (g_type_info_get_array_type(&array_type_info) != GI_ARRAY_TYPE_C) {
+        throw UnsupportedGIType("only C arrays can be passed to native functions");
+    }
+
+    auto element_type_info = GIRInfoUniquePtr(g_type_info_get_param_type(&array_type_info, 0));
+    GITypeTag element_tag = g_type_info_get_tag(element_type_info.get());
+    GIRInfoUniquePtr element_interface_info = nullptr;
+    if (element_tag == GI_TYPE_TAG_INTERFACE) {
+        element_interface_info = GIRInfoUniquePtr(g_type_info_get_interface(element_type_info.get()));
+    }
+    bool is_pointer_array = g_type_info_is_pointer(element_type_info.get());
+    size_t element_size = get_array_element_size(element_type_info.get(), element_tag, element_interface_info.get());
+    GITypeTag storage_tag = get_array_element_storage_tag(element_tag, element_interface_info.get());
+    bool is_zero_terminated = g_type_info_is_zero_terminated(&array_type_info);
+    int fixed_size = g_type_info_get_array_fixed_size(&array_type_info);
+
+    Arena *container_arena = transfer == GI_TRANSFER_NOTHING ? arena : nullptr;
+    Arena *element_arena = transfer == GI_TRANSFER_EVERYTHING ? nullptr : arena;
+
+    GIArgument argument_value;
+    argument_value.v_pointer = nullptr;
+
+    // raw memory (ArrayBuffers, DataViews and TypedArrays with the right element type)
+    bool is_raw_memory = js_value->IsArrayBuffer() ||
+                         (js_value->IsArrayBufferView() &&
+                          (!js_value->IsTypedArray() || Args::typed_array_matches(js_value, storage_tag)));
+    if (!is_pointer_array && is_raw_memory) {
+        guint8 *data;
+        size_t byte_length;
+        if (js_value->IsArrayBuffer()) {
+            Local<ArrayBuffer> buffer = js_value.As<ArrayBuffer>();
+            data = static_cast<guint8 *>(buffer->GetContents().Data());
+            byte_length = buffer->ByteLength();
+        } else {
+            Local<ArrayBufferView> view = js_value.As<ArrayBufferView>();
+            data = static_cast<guint8 *>(view->Buffer()->GetContents().Data()) + view->ByteOffset();
+            byte_length = view->ByteLength();
+        }
+        size_t length = byte_length / element_size;
+        if (fixed_size >= 0 && length < (size_t)fixed_size) {
+            throw JSArgumentTypeError();
+        }
+
+        if (container_arena == nullptr || is_zero_terminated) {
+            // we can't hand out the JS memory if the native function will free it or
+            // if it needs an extra zero element at the end.
+            size_t terminator_size = is_zero_terminated ? element_size : 0;
+            guint8 *native_array = allocate_native_array(container_arena, length * element_size + terminator_size);
+            memcpy(native_array, data, length * element_size);
+            argument_value.v_pointer = native_array;
+        } else {
+            // the JS value is kept alive by the JS function call so it's
+            // memory is valid for as long as the native call runs.
+            argument_value.v_pointer = data;
+        }
+
+        if (array_length != nullptr) {
+            *array_length = length;
+        }
+        return argument_value;
+    }
+
+    if (!js_value->IsArray() && !js_value->IsTypedArray()) {
+        throw JSArgumentTypeError();
+    }
+
+    // arrays of strings that only live for the call (i.e. GStrv) are packed
+    // into a single allocation rather than copying each string separately.
+    bool is_string_array = element_tag == GI_TYPE_TAG_UTF8 || element_tag == GI_TYPE_TAG_FILENAME;
+    if (is_string_array && js_value->IsArray() && transfer == GI_TRANSFER_NOTHING && arena != nullptr) {
+        Local<Array> js_strings = js_value.As<Array>();
+        if (fixed_size >= 0 && js_strings->Length() < (size_t)fixed_size) {
+            throw JSArgumentTypeError();
+        }
+        argument_value.v_pointer = strv_to_g_type(js_strings, arena);
+        if (array_length != nullptr) {
+            *array_length = js_strings->Length();
+        }
+        return argument_value;
+    }
+
+    Local<Object> js_array = js_value.As<Object>();
+    size_t length = js_value->IsArray() ? js_value.As<Array>()->Length() : js_value.As<TypedArray>()->Length();
+    if (fixed_size >= 0 && length < (size_t)fixed_size) {
+        throw JSArgumentTypeError();
+    }
+
+    size_t terminator_size = is_zero_terminated ? element_size : 0;
+    guint8 *native_array = allocate_native_array(container_arena, length * element_size + terminator_size);
+    bool is_struct_array = !is_pointer_array && element_tag == GI_TYPE_TAG_INTERFACE &&
+                           storage_tag == GI_TYPE_TAG_INTERFACE;
+    for (size_t i = 0; i < length; i++) {
+        GIArgument element = Args::type_to_g_type(*element_type_info,
+                                                  element_tag,
+                                                  element_interface_info.get(),
+                                                  js_array->Get(i),
+                                                  element_arena);
+        guint8 *native_element = native_array + i * element_size;
+        if (is_struct_array) {
+            // structs are copied into the array itself
+            memcpy(native_element, element.v_pointer, element_size);
+        } else {
+            // every GIArgument field starts at the beginning of the union
+            // so we can copy the element straight out of it
+            memcpy(native_element, &element, element_size);
+        }
+    }
+
+    argument_value.v_pointer = native_array;
+    if (array_length != nullptr) {
+        *array_length = length;
+    }
+    return argument_value;
+}
+
+/**
+ * GHashTables (and GLists) store their keys and values as pointers. Numbers are
+ * packed into the pointer itself (i.e. GINT_TO_POINTER) so this unpacks
+ * them into the right GIArgument field.
+ */
+GIArgument Args::pointer_to_g_argument(gpointer data, GITypeTag tag, GIBaseInfo *interface_info) {
+    GIArgument argument;
+    memset(&argument, 0, sizeof(GIArgument));
+    switch (tag) {
+        case GI_TYPE_TAG_BOOLEAN:
+            argument.v_boolean = GPOINTER_TO_INT(data);
+            break;
+        case GI_TYPE_TAG_INT8:
+            argument.v_int8 = static_cast<gint8>(GPOINTER_TO_INT(data));
+            break;
+        case GI_TYPE_TAG_UINT8:
+            argument.v_uint8 = static_cast<guint8>(GPOINTER_TO_UINT(data));
+            break;
+        case GI_TYPE_TAG_INT16:
+            argument.v_int16 = static_cast<gint16>(GPOINTER_TO_INT(data));
+            break;
+        case GI_TYPE_TAG_UINT16:
+            argument.v_uint16 = static_cast<guint16>(GPOINTER_TO_UINT(data));
+            break;
+        case GI_TYPE_TAG_INT32:
+            argument.v_int32 = GPOINTER_TO_INT(data);
+            break;
+        case GI_TYPE_TAG_UINT32:
+        case GI_TYPE_TAG_UNICHAR:
+            argument.v_uint32 = GPOINTER_TO_UINT(data);
+            break;
+        case GI_TYPE_TAG_INTERFACE: {
+            GIInfoType interface_type = g_base_info_get_type(interface_info);
+            if (interface_type == GI_INFO_TYPE_ENUM || interface_type == GI_INFO_TYPE_FLAGS) {
+                argument.v_int = GPOINTER_TO_INT(data);
             } else {
-                // use array_length param once the layers above this
-                // pas it correctly.
-                // the length param comes from the native function call's
-                // out arguments but, currently, it doesn't get passed own
-                // here correctly.
-                throw UnsupportedGIType("Converting non null terminated arrays is not yet supported");
+                argument.v_pointer = data;
             }
+        } break;
+        default:
+            argument.v_pointer = data;
             break;
+    }
+    return argument;
+}
+
+/**
+ * The reverse of pointer_to_g_argument.
+ * Values that don't fit in a pointer (64 bit integers and floating point numbers)
+ * aren't supported.
+ */
+gpointer Args::g_argument_to_pointer(GIArgument &argument, GITypeTag tag, GIBaseInfo *interface_info) {
+    switch (tag) {
+        case GI_TYPE_TAG_BOOLEAN:
+            return GINT_TO_POINTER(argument.v_boolean);
+        case GI_TYPE_TAG_INT8:
+            return GINT_TO_POINTER(argument.v_int8);
+        case GI_TYPE_TAG_UINT8:
+            return GUINT_TO_POINTER(argument.v_uint8);
+        case GI_TYPE_TAG_INT16:
+            return GINT_TO_POINTER(argument.v_int16);
+        case GI_TYPE_TAG_UINT16:
+            return GUINT_TO_POINTER(argument.v_uint16);
+        case GI_TYPE_TAG_INT32:
+            return GINT_TO_POINTER(argument.v_int32);
+        case GI_TYPE_TAG_UINT32:
+        case GI_TYPE_TAG_UNICHAR:
+            return GUINT_TO_POINTER(argument.v_uint32);
+        case GI_TYPE_TAG_INT64:
+        case GI_TYPE_TAG_UINT64:
+        case GI_TYPE_TAG_FLOAT:
+        case GI_TYPE_TAG_DOUBLE:
+        case GI_TYPE_TAG_GTYPE: {
+            stringstream message;
+            message << "\"" << g_type_tag_to_string(tag) << "\" can't be stored in a pointer sized container";
+            throw UnsupportedGIType(message.str());
+        }
+        case GI_TYPE_TAG_INTERFACE: {
+            GIInfoType interface_type = g_base_info_get_type(interface_info);
+            if (interface_type == GI_INFO_TYPE_ENUM || interface_type == GI_INFO_TYPE_FLAGS) {
+                return GINT_TO_POINTER(argument.v_int);
+            }
+            return argument.v_pointer;
+        }
         default:
-            throw UnsupportedGIType("cannot convert native array type");
+            return argument.v_pointer;
     }
+}
 
-    stringstream message;
-    message << "Converting array of type '" << g_type_tag_to_string(param_tag);
-    message << "' is not supported";
-    throw UnsupportedGIType(message.str());
+/**
+ * Converts a JS Map (or a plain object) into a GHashTable using the
+ * table's key and value types.
+ * If there's an arena then our reference to the table is dropped with it, otherwise
+ * the caller owns the table. String keys and values are always owned (and freed) by
+ * the table itself, so they stay valid if the callee keeps a reference to the table.
+ */
+GHashTable *Args::hash_to_g_type(GITypeInfo &hash_type_info, Local<Value> js_value, Arena *arena) {
+    if (!js_value->IsObject()) {
+        throw JSArgumentTypeError();
+    }
+
+    // work out how to convert the keys and values once rather than per entry
+    GIRInfoUniquePtr key_type_info = GIRInfoUniquePtr(g_type_info_get_param_type(&hash_type_info, 0));
+    GIRInfoUniquePtr value_type_info = GIRInfoUniquePtr(g_type_info_get_param_type(&hash_type_info, 1));
+    GITypeTag key_tag = g_type_info_get_tag(key_type_info.get());
+    GITypeTag value_tag = g_type_info_get_tag(value_type_info.get());
+    GIRInfoUniquePtr key_interface_info = nullptr;
+    GIRInfoUniquePtr value_interface_info = nullptr;
+    if (key_tag == GI_TYPE_TAG_INTERFACE) {
+        key_interface_info = GIRInfoUniquePtr(g_type_info_get_interface(key_type_info.get()));
+    }
+    if (value_tag == GI_TYPE_TAG_INTERFACE) {
+        value_interface_info = GIRInfoUniquePtr(g_type_info_get_interface(value_type_info.get()));
+    }
+
+    bool string_keys = key_tag == GI_TYPE_TAG_UTF8 || key_tag == GI_TYPE_TAG_FILENAME;
+    bool string_values = value_tag == GI_TYPE_TAG_UTF8 || value_tag == GI_TYPE_TAG_FILENAME;
+    GHashTable *table = g_hash_table_new_full(string_keys ? g_str_hash : g_direct_hash,
+                                              string_keys ? g_str_equal : g_direct_equal,
+                                              string_keys ? g_free : nullptr,
+                                              string_values ? g_free : nullptr);
+    // strings converted without an arena are g_strdup'd, the table frees them
+    Arena *key_arena = string_keys ? nullptr : arena;
+    Arena *value_arena = string_values ? nullptr : arena;
+    if (arena != nullptr) {
+        arena->add_cleanup((GDestroyNotify)g_hash_table_unref, table);
+    }
+
+    // a Map flattens to [key, value, key, value, ...]. For a plain
+    // object we'll use it's own property names as the keys.
+    Local<Object> js_object = js_value->ToObject();
+    Local<Array> entries;
+    bool is_map = js_value->IsMap();
+    if (is_map) {
+        entries = js_value.As<Map>()->AsArray();
+    } else {
+        entries = Nan::GetOwnPropertyNames(js_object).ToLocalChecked();
+    }
+    uint32_t n_entries = is_map ? entries->Length() / 2 : entries->Length();
+
+    try {
+        for (uint32_t i = 0; i < n_entries; i++) {
+            Local<Value> js_key = Nan::Get(entries, is_map ? i * 2 : i).ToLocalChecked();
+            Local<Value> js_entry_value = is_map ? Nan::Get(entries, i * 2 + 1).ToLocalChecked()
+                                                 : Nan::Get(js_object, js_key).ToLocalChecked();
+            GIArgument key =
+                Args::type_to_g_type(*key_type_info, key_tag, key_interface_info.get(), js_key, key_arena);
+            GIArgument value = Args::type_to_g_type(*value_type_info,
+                                                    value_tag,
+                                                    value_interface_info.get(),
+                                                    js_entry_value,
+                                                    value_arena);
+            g_hash_table_insert(table,
+                                Args::g_argument_to_pointer(key, key_tag, key_interface_info.get()),
+                                Args::g_argument_to_pointer(value, value_tag, value_interface_info.get()));
+        }
+    } catch (...) {
+        if (arena == nullptr) {
+            g_hash_table_unref(table);
+        }
+        throw;
+    }
+    return table;
+}
+
+/**
+ * Converts a native GHashTable into a JS Map in a single pass over the table.
+ * If we own the table and it's elements (transfer full) then the table frees it's own
+ * keys and values (with the destroy functions it was created with) when we drop our
+ * reference. If we only own the container then the elements are stolen first so
+ * they aren't freed.
+ */
+Local<Value> Args::from_g_type_hash(GIArgument *arg, GITypeInfo *type_info, GITransfer transfer) {
+    GHashTable *table = static_cast<GHashTable *>(arg->v_pointer);
+    if (table == nullptr) {
+        return Nan::Null();
+    }
+
+    GIRInfoUniquePtr key_type_info = GIRInfoUniquePtr(g_type_info_get_param_type(type_info, 0));
+    GIRInfoUniquePtr value_type_info = GIRInfoUniquePtr(g_type_info_get_param_type(type_info, 1));
+    GITypeTag key_tag = g_type_info_get_tag(key_type_info.get());
+    GITypeTag value_tag = g_type_info_get_tag(value_type_info.get());
+    GIRInfoUniquePtr key_interface_info = nullptr;
+    GIRInfoUniquePtr value_interface_info = nullptr;
+    if (key_tag == GI_TYPE_TAG_INTERFACE) {
+        key_interface_info = GIRInfoUniquePtr(g_type_info_get_interface(key_type_info.get()));
+    }
+    if (value_tag == GI_TYPE_TAG_INTERFACE) {
+        value_interface_info = GIRInfoUniquePtr(g_type_info_get_interface(value_type_info.get()));
+    }
+
+    Local<Context> context = Nan::GetCurrentContext();
+    Local<Map> js_map = Map::New(Isolate::GetCurrent());
+    GHashTableIter iter;
+    gpointer native_key;
+    gpointer native_value;
+    g_hash_table_iter_init(&iter, table);
+    try {
+        while (g_hash_table_iter_next(&iter, &native_key, &native_value)) {
+            GIArgument key = Args::pointer_to_g_argument(native_key, key_tag, key_interface_info.get());
+            GIArgument value = Args::pointer_to_g_argument(native_value, value_tag, value_interface_info.get());
+            Local<Value> js_key = Args::from_g_type(&key, key_type_info.get(), key_tag, key_interface_info.get(), -1);
+            Local<Value> js_value = Args::from_g_type(&value,
+                                                      value_type_info.get(),
+                                                      value_tag,
+                                                      value_interface_info.get(),
+                                                      -1);
+            js_map->Set(context, js_key, js_value).ToLocalChecked();
+        }
+    } catch (...) {
+        Args::release_g_hash_table(table, transfer);
+        throw;
+    }
+
+    Args::release_g_hash_table(table, transfer);
+    return js_map;
+}
+
+void Args::release_g_hash_table(GHashTable *table, GITransfer transfer) {
+    if (transfer == GI_TRANSFER_CONTAINER) {
+        g_hash_table_steal_all(table);
+    }
+    if (transfer != GI_TRANSFER_NOTHING) {
+        g_hash_table_unref(table);
+    }
 }
 
 // TODO: refactor this function and most of the code below this.
 // can we reuse code from GIRValue?
-Local<Value> Args::from_g_type(GIArgument *arg, GITypeInfo *type, int array_length) {
+Local<Value> Args::from_g_type(GIArgument *arg, GITypeInfo *type, int array_length, GITransfer transfer) {
     GITypeTag tag = g_type_info_get_tag(type);
+    GIRInfoUniquePtr interface_info = nullptr;
+    if (tag == GI_TYPE_TAG_INTERFACE) {
+        interface_info = GIRInfoUniquePtr(g_type_info_get_interface(type));
+    }
+    return Args::from_g_type(arg, type, tag, interface_info.get(), array_length, transfer);
+}
 
+/**
+ * Converts a native GIArgument into a JS value. Like type_to_g_type, callers
+ * that already know the type tag and interface info can pass them in.
+ * @param interface_info should be nullptr unless tag is GI_TYPE_TAG_INTERFACE
+ * @param transfer is the ownership transfer of the native value (i.e. the return
+ *        value's or out argument's). Values we own are adopted (or freed once
+ *        they've been converted) and values we don't own are copied or ref'd.
+ * @param view_owner is passed on to from_g_type_array when the value is an array.
+ */
+Local<Value> Args::from_g_type(GIArgument *arg,
+                               GITypeInfo *type,
+                               GITypeTag tag,
+                               GIBaseInfo *interface_info,
+                               int array_length,
+                               GITransfer transfer,
+                               const ArrayViewOwner *view_owner) {
     switch (tag) {
         case GI_TYPE_TAG_VOID:
             return Nan::Undefined();
@@ -404,32 +1356,47 @@ Local<Value> Args::from_g_type(GIArgument *arg, GITypeInfo *type, int array_leng
             return Nan::New(arg->v_uint);
 
         case GI_TYPE_TAG_UTF8:
-            return Nan::New(arg->v_string).ToLocalChecked();
-
-        case GI_TYPE_TAG_FILENAME:
-            return Nan::New(arg->v_string).ToLocalChecked();
+        case GI_TYPE_TAG_FILENAME: {
+            if (arg->v_string == nullptr) {
+                return Nan::Null();
+            }
+            Local<Value> js_string = Nan::New(arg->v_string).ToLocalChecked();
+            if (transfer != GI_TRANSFER_NOTHING) {
+                g_free(arg->v_string);
+            }
+            return js_string;
+        }
 
         case GI_TYPE_TAG_ARRAY:
-            return Args::from_g_type_array(arg, type, array_length);
+            return Args::from_g_type_array(arg, type, array_length, transfer, view_owner);
 
         case GI_TYPE_TAG_INTERFACE: {
-            GIBaseInfo *interface_info = g_type_info_get_interface(type);
             GIInfoType interface_type = g_base_info_get_type(interface_info);
             switch (interface_type) {
                 case GI_INFO_TYPE_OBJECT:
                     if (arg->v_pointer == nullptr) {
                         return Nan::Null();
                     }
-                    return GIRObject::from_existing(G_OBJECT(arg->v_pointer), interface_info);
+                    return GIRObject::from_existing(G_OBJECT(arg->v_pointer), interface_info, transfer);
 
                 case GI_INFO_TYPE_INTERFACE:
+                    if (arg->v_pointer == nullptr) {
+                        return Nan::Null();
+                    }
+                    // an interface value is an object implementing it (i.e. a GFile is a GLocalFile),
+                    // from_existing wraps it with the object's runtime class.
+                    if (!G_IS_OBJECT(arg->v_pointer)) {
+                        throw UnsupportedGIType("cannot convert an interface value that isn't a GObject to a JS value");
+                    }
+                    return GIRObject::from_existing(G_OBJECT(arg->v_pointer), nullptr, transfer);
+
                 case GI_INFO_TYPE_UNION:
                 case GI_INFO_TYPE_STRUCT:
                 case GI_INFO_TYPE_BOXED:
                     if (arg->v_pointer == nullptr) {
                         return Nan::Null();
                     }
-                    return GIRStruct::from_existing(arg->v_pointer, interface_info);
+                    return GIRStruct::from_existing(arg->v_pointer, interface_info, transfer);
 
                 case GI_INFO_TYPE_VALUE:
                     return GIRValue::from_g_value(static_cast<GValue *>(arg->v_pointer), nullptr);
@@ -447,11 +1414,12 @@ Local<Value> Args::from_g_type(GIArgument *arg, GITypeInfo *type, int array_leng
         } break;
 
         case GI_TYPE_TAG_GLIST:
-            return Nan::Undefined();
         case GI_TYPE_TAG_GSLIST:
-            return Nan::Undefined();
+            // a null list is an empty list
+            return GIRList::from_existing(arg->v_pointer, type, transfer);
+
         case GI_TYPE_TAG_GHASH:
-            return Nan::Undefined();
+            return Args::from_g_type_hash(arg, type, transfer);
         case GI_TYPE_TAG_ERROR:
             return Nan::Undefined();
         case GI_TYPE_TAG_UNICHAR:
@@ -5,6 +5,9 @@
 #include <nan.h>
 #include <v8.h>
 #include <vector>
+#include "internal/Arena.h"
+#include "internal/InlineVector.h"
+#include "call_plan.h"
 #include "util.h"
 
 namespace gir {
@@ -12,30 +15,95 @@ namespace gir {
 using namespace std;
 using namespace v8;
 
+// most native functions take fewer arguments than this so Args can
+// hold them without allocating.
+const size_t ARGS_INLINE_CAPACITY = 8;
+
+using ArgumentVector = InlineVector<GIArgument, ARGS_INLINE_CAPACITY>;
+
+/**
+ * The native value (i.e. a GObject or GBytes) that owns the memory of the arrays
+ * a native function returns. It's used to expose that memory to JS as an external
+ * ArrayBuffer rather than copying it; 'ref' is called to keep the owner alive and
+ * 'unref' is called when V8 frees the ArrayBuffer.
+ * 'owner' is nullptr if there's nothing we can take a reference on.
+ */
+struct ArrayViewOwner {
+    gpointer owner;
+    gpointer (*ref)(gpointer owner);
+    GDestroyNotify unref;
+};
+
 class Args {
 public:
-    vector<GIArgument> in;
-    vector<GIArgument> out;
+    // 'in' is sized from the CallPlan up front. When the plan is a method,
+    // in[0] is reserved for the value of 'this' (see load_context).
+    ArgumentVector in;
+    ArgumentVector out;
 
-    Args(GICallableInfo *callable_info);
+    Args(const CallPlan &plan);
 
-    void load_js_arguments(const Nan::FunctionCallbackInfo<Value> &js_callback_info);
+    void load_js_arguments(const Nan::FunctionCallbackInfo<Value> &js_callback_info, int js_offset = 0);
+    void load_js_arguments(const Local<Value> *js_values, int n_js_values);
+    void load_out_arguments();
     void load_context(GObject *this_object);
+    int get_array_length(int array_length_index);
+    void reset();
 
 private:
-    GIRInfoUniquePtr callable_info;
-    GIArgument get_in_argument_value(const Local<Value> &js_value, GIArgInfo &argument_info);
-    GIArgument get_out_argument_value(GIArgInfo &argument_info);
+    const CallPlan &plan;
+
+    // temporaries created while converting the arguments (strings, GValues,
+    // caller-allocated out structs, etc). They're released with Args.
+    Arena arena;
+
+    void load_argument(const ArgumentPlan &argument, Local<Value> js_value);
+    GIArgument get_out_argument_value(const ArgumentPlan &argument);
+    void set_array_length(int array_length_index, size_t length);
     static GITypeTag map_g_type_tag(GITypeTag type);
 
 public:
     // these functions are legacy and need to be refactored
     // there are many missing features within them as well such as missing type conversions (types that aren't supported
     // like structs.)
-    static GIArgument arg_to_g_type(GIArgInfo &argument_info, Local<Value> js_value);
-    static GIArgument type_to_g_type(GITypeInfo &argument_type_info, Local<Value> js_value);
-    static Local<Value> from_g_type_array(GIArgument *arg, GIArgInfo *info, int array_length);
-    static Local<Value> from_g_type(GIArgument *arg, GITypeInfo *type_info, int array_length);
+    static GIArgument arg_to_g_type(const ArgumentPlan &argument,
+                                    Local<Value> js_value,
+                                    Arena *arena,
+                                    size_t *array_length = nullptr);
+    static GIArgument type_to_g_type(GITypeInfo &argument_type_info, Local<Value> js_value, Arena *arena = nullptr);
+    static GIArgument type_to_g_type(GITypeInfo &argument_type_info,
+                                     GITypeTag argument_type_tag,
+                                     GIBaseInfo *interface_info,
+                                     Local<Value> js_value,
+                                     Arena *arena = nullptr);
+    static GIArgument array_to_g_type(GITypeInfo &array_type_info,
+                                      Local<Value> js_value,
+                                      Arena *arena,
+                                      GITransfer transfer,
+                                      size_t *array_length);
+    static GHashTable *hash_to_g_type(GITypeInfo &hash_type_info, Local<Value> js_value, Arena *arena);
+    static Local<Value> from_g_type_hash(GIArgument *arg, GITypeInfo *type_info, GITransfer transfer);
+    static void release_g_hash_table(GHashTable *table, GITransfer transfer);
+    static GIArgument pointer_to_g_argument(gpointer data, GITypeTag tag, GIBaseInfo *interface_info);
+    static gpointer g_argument_to_pointer(GIArgument &argument, GITypeTag tag, GIBaseInfo *interface_info);
+    static bool typed_array_matches(Local<Value> typed_array, GITypeTag storage_tag);
+    static Local<Value> from_g_type_numeric_array(gpointer data, size_t length, GITypeTag element_tag);
+    static Local<Value> from_g_type_array(GIArgument *arg,
+                                          GITypeInfo *type_info,
+                                          int array_length,
+                                          GITransfer transfer = GI_TRANSFER_NOTHING,
+                                          const ArrayViewOwner *view_owner = nullptr);
+    static Local<Value> from_g_type(GIArgument *arg,
+                                    GITypeInfo *type_info,
+                                    int array_length,
+                                    GITransfer transfer = GI_TRANSFER_NOTHING);
+    static Local<Value> from_g_type(GIArgument *arg,
+                                    GITypeInfo *type_info,
+                                    GITypeTag tag,
+                                    GIBaseInfo *interface_info,
+                                    int array_length,
+                                    GITransfer transfer = GI_TRANSFER_NOTHING,
+                                    const ArrayViewOwner *view_owner = nullptr);
 };
 
 } // namespace gir
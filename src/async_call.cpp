@@ -0,0 +1,441 @@
+#include "async_call.h"
+#include <cstring>
+#include <exception>
+#include "exceptions.h"
+#include "types/function.h"
+#include "types/object.h"
+
+namespace gir {
+
+using namespace std;
+
+/**
+ * the callback we pass to Nan. It settles a Promise (the function's data) with a
+ * node style (error, result) pair. Settling the Promise from a callback that Nan calls
+ * (rather than directly) makes sure it's reactions run straight away.
+ */
+static NAN_METHOD(settle_promise) {
+    Local<Promise::Resolver> resolver = info.Data().As<Promise::Resolver>();
+    Local<Context> context = Nan::GetCurrentContext();
+    if (info[0]->IsNullOrUndefined()) {
+        resolver->Resolve(context, info[1]).FromJust();
+    } else {
+        resolver->Reject(context, info[0]).FromJust();
+    }
+}
+
+// JS callbacks can't be called from the threadpool
+static void check_no_callbacks(const CallPlan &plan) {
+    for (const ArgumentPlan &argument : plan.arguments) {
+        if (argument.interface_type == GI_INFO_TYPE_CALLBACK) {
+            throw JSArgumentTypeError("functions that take a callback can't be called asynchronously");
+        }
+    }
+}
+
+AsyncCall::AsyncCall(const CallPlan &plan, Nan::Callback *settle)
+    : Nan::AsyncWorker(settle, "gir:AsyncCall"), plan(plan), args(plan) {
+    this->result.v_pointer = nullptr;
+}
+
+/**
+ * Converts the JS arguments and queues the native call.
+ * Returns a Promise that resolves with the function's return value (following
+ * the same rules as a regular call) or rejects if the arguments can't be converted
+ * or the native function fails.
+ * @param js_offset is the position of the first JS argument that maps to a native argument
+ */
+Local<Value> AsyncCall::start(GObject *instance,
+                              const CallPlan &plan,
+                              const Nan::FunctionCallbackInfo<Value> &js_callback_info,
+                              int js_offset) {
+    Local<Context> context = Nan::GetCurrentContext();
+    Local<Promise::Resolver> resolver = Promise::Resolver::New(context).ToLocalChecked();
+    Local<Function> settle = Nan::New<Function>(settle_promise, resolver);
+    AsyncCall *async_call = new AsyncCall(plan, new Nan::Callback(settle));
+
+    try {
+        check_no_callbacks(plan);
+        async_call->args.load_js_arguments(js_callback_info, js_offset);
+        if (plan.is_method) {
+            if (instance == nullptr) {
+                throw JSArgumentTypeError("method calls require a native object as the first argument");
+            }
+            async_call->args.load_context(instance);
+        }
+    } catch (exception &error) {
+        delete async_call;
+        resolver->Reject(context, Nan::Error(error.what())).FromJust();
+        return resolver->GetPromise();
+    }
+
+    // the native arguments may point into the JS arguments (strings are copied but
+    // buffers and wrapped objects aren't) so we keep them alive until the call is done.
+    for (int i = 0; i < js_callback_info.Length(); i++) {
+        async_call->SaveToPersistent(i, js_callback_info[i]);
+    }
+    Nan::AsyncQueueWorker(async_call);
+    return resolver->GetPromise();
+}
+
+/**
+ * runs on the threadpool, V8 can't be used in here!
+ */
+void AsyncCall::Execute() {
+    try {
+        this->result = GIRFunction::call_native(this->plan, this->args);
+    } catch (exception &error) {
+        this->SetErrorMessage(error.what());
+    }
+}
+
+void AsyncCall::HandleOKCallback() {
+    Nan::HandleScope scope;
+    Local<Value> js_result;
+    try {
+        js_result = GIRFunction::js_return_value_from_native_call(this->plan, this->args, this->result, nullptr);
+    } catch (exception &error) {
+        Local<Value> argv[] = {Nan::Error(error.what())};
+        this->callback->Call(1, argv, this->async_resource);
+        return;
+    }
+    Local<Value> argv[] = {Nan::Null(), js_result};
+    this->callback->Call(2, argv, this->async_resource);
+}
+
+/**
+ * The AsyncWorker for one chunk of a ParallelCall. The last chunk
+ * to finish gathers the results and settles the Promise.
+ */
+class ParallelCall::Chunk : public Nan::AsyncWorker {
+public:
+    Chunk(ParallelCall *parallel_call, size_t begin, size_t end, Nan::Callback *settle)
+        : Nan::AsyncWorker(settle, "gir:ParallelCall"), parallel_call(parallel_call), begin(begin), end(end) {}
+
+    // runs on the threadpool, V8 can't be used in here!
+    void Execute() override {
+        this->parallel_call->run(this->begin, this->end);
+    }
+
+protected:
+    void HandleOKCallback() override {
+        this->parallel_call->pending_chunks--;
+        if (this->parallel_call->pending_chunks > 0) {
+            return;
+        }
+        Nan::HandleScope scope;
+        Local<Value> js_results = this->parallel_call->gather_results();
+        int first_error = -1;
+        for (size_t i = 0; i < this->parallel_call->errors.size() && first_error < 0; i++) {
+            if (!this->parallel_call->errors[i].empty()) {
+                first_error = i;
+            }
+        }
+        Local<Value> argv[] = {Nan::Null(), js_results};
+        if (first_error >= 0) {
+            argv[0] = Nan::Error(this->parallel_call->errors[first_error].c_str());
+        }
+        delete this->parallel_call;
+        this->callback->Call(2, argv, this->async_resource);
+    }
+
+private:
+    ParallelCall *parallel_call;
+    size_t begin;
+    size_t end;
+};
+
+ParallelCall::ParallelCall(const CallPlan &plan) : plan(plan) {}
+
+ParallelCall::~ParallelCall() {
+    this->js_values.Reset();
+}
+
+/**
+ * Converts the arguments of every call in the batch and queues the chunks.
+ * Returns a Promise that resolves with an array of the calls' return values
+ * (following the same rules as a regular call) or rejects with the first error.
+ * Methods take their instance as the first element of each argument array.
+ */
+Local<Value> ParallelCall::start(const CallPlan &plan, Local<Array> batch) {
+    Local<Context> context = Nan::GetCurrentContext();
+    Local<Promise::Resolver> resolver = Promise::Resolver::New(context).ToLocalChecked();
+    ParallelCall *parallel_call = new ParallelCall(plan);
+    uint32_t n_calls = batch->Length();
+    int this_offset = plan.is_method ? 1 : 0;
+    Local<Array> all_js_values = Nan::New<Array>();
+    uint32_t n_js_values = 0;
+    parallel_call->js_values.Reset(all_js_values);
+
+    try {
+        check_no_callbacks(plan);
+        vector<Local<Value>> js_values;
+        for (uint32_t i = 0; i < n_calls; i++) {
+            Local<Value> js_row = Nan::Get(batch, i).ToLocalChecked();
+            if (!js_row->IsArray()) {
+                throw JSArgumentTypeError("every element of the batch should be an array of arguments");
+            }
+            Local<Array> row = js_row.As<Array>();
+            js_values.resize(row->Length());
+            for (uint32_t j = 0; j < row->Length(); j++) {
+                js_values[j] = Nan::Get(row, j).ToLocalChecked();
+                Nan::Set(all_js_values, n_js_values++, js_values[j]);
+            }
+
+            unique_ptr<Args> args = unique_ptr<Args>(new Args(plan));
+            if (plan.is_method) {
+                if (js_values.empty() || !js_values[0]->IsObject()) {
+                    throw JSArgumentTypeError("the first argument of every call should be the instance of the method");
+                }
+                ArrayViewOwner unused_view_owner = {nullptr, nullptr, nullptr};
+                gpointer instance = GIRFunction::get_instance(plan, js_values[0], &unused_view_owner);
+                if (instance == nullptr) {
+                    throw JSArgumentTypeError("method calls require a native object as the first argument");
+                }
+                args->load_context((GObject *)instance);
+            }
+            args->load_js_arguments(js_values.data() + this_offset, (int)js_values.size() - this_offset);
+            parallel_call->calls.push_back(move(args));
+        }
+    } catch (exception &error) {
+        delete parallel_call;
+        resolver->Reject(context, Nan::Error(error.what())).FromJust();
+        return resolver->GetPromise();
+    }
+
+    if (n_calls == 0) {
+        delete parallel_call;
+        resolver->Resolve(context, Nan::New<Array>()).FromJust();
+        return resolver->GetPromise();
+    }
+
+    parallel_call->results.resize(n_calls);
+    parallel_call->errors.resize(n_calls);
+    size_t n_chunks = MIN((size_t)MAX(g_get_num_processors(), 1), n_calls);
+    parallel_call->pending_chunks = n_chunks;
+    Local<Function> settle = Nan::New<Function>(settle_promise, resolver);
+    for (size_t i = 0; i < n_chunks; i++) {
+        size_t begin = n_calls * i / n_chunks;
+        size_t end = n_calls * (i + 1) / n_chunks;
+        Nan::AsyncQueueWorker(new ParallelCall::Chunk(parallel_call, begin, end, new Nan::Callback(settle)));
+    }
+    return resolver->GetPromise();
+}
+
+/**
+ * calls the native function for a range of the batch.
+ * runs on the threadpool, V8 can't be used in here!
+ */
+void ParallelCall::run(size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        try {
+            this->results[i] = GIRFunction::call_native(this->plan, *this->calls[i]);
+        } catch (exception &error) {
+            this->errors[i] = error.what();
+        }
+    }
+}
+
+/**
+ * converts the results of every call that succeeded, calls that failed are left undefined.
+ * Results are converted even if we're going to reject so that anything the native
+ * function gave us ownership of is freed.
+ */
+Local<Value> ParallelCall::gather_results() {
+    Local<Array> js_results = Nan::New<Array>(this->calls.size());
+    for (size_t i = 0; i < this->calls.size(); i++) {
+        if (!this->errors[i].empty()) {
+            continue;
+        }
+        try {
+            Local<Value> js_result =
+                GIRFunction::js_return_value_from_native_call(this->plan, *this->calls[i], this->results[i], nullptr);
+            Nan::Set(js_results, i, js_result);
+        } catch (exception &error) {
+            this->errors[i] = error.what();
+        }
+    }
+    return js_results;
+}
+
+// returns true if the argument is the Gio type with the given name
+static bool is_gio_type(const ArgumentPlan &argument, const char *type_name) {
+    if (argument.interface_info == nullptr) {
+        return false;
+    }
+    return strcmp(g_base_info_get_namespace(argument.interface_info.get()), "Gio") == 0 &&
+           strcmp(g_base_info_get_name(argument.interface_info.get()), type_name) == 0;
+}
+
+AsyncReadyCall::AsyncReadyCall(const AsyncReadyPlan &plan, Local<Function> settle)
+    : plan(plan), args(plan.start), settle(settle), async_resource("gir:AsyncReadyCall") {}
+
+AsyncReadyCall::~AsyncReadyCall() {
+    this->js_arguments.Reset();
+}
+
+/**
+ * Works out which arguments we fill in natively using the functions' GI metadata.
+ * The _async function must take a GAsyncReadyCallback (with user_data) and the
+ * _finish function must only take a GAsyncResult, otherwise it returns nullptr.
+ * Like CallPlans, the plan lives as long as it's function templates so it's never freed.
+ */
+AsyncReadyPlan *AsyncReadyCall::create_plan(GIFunctionInfo *start_info, GIFunctionInfo *finish_info) {
+    AsyncReadyPlan *plan = new AsyncReadyPlan(start_info, finish_info);
+    plan->callback_index = -1;
+    plan->user_data_index = -1;
+    plan->result_index = -1;
+
+    int start_this_offset = plan->start.is_method ? 1 : 0;
+    int n_start_arguments = plan->start.arguments.size();
+    for (int i = 0; i < n_start_arguments; i++) {
+        const ArgumentPlan &argument = plan->start.arguments[i];
+        if (argument.direction == GI_DIRECTION_IN && is_gio_type(argument, "AsyncReadyCallback")) {
+            int closure_index = g_arg_info_get_closure(&argument.arg_info);
+            if (closure_index >= 0 && closure_index < n_start_arguments) {
+                plan->callback_index = start_this_offset + argument.in_index;
+                plan->user_data_index = start_this_offset + plan->start.arguments[closure_index].in_index;
+                plan->start.skip_js_argument(i);
+                plan->start.skip_js_argument(closure_index);
+            }
+            break;
+        }
+    }
+
+    int finish_this_offset = plan->finish.is_method ? 1 : 0;
+    for (const ArgumentPlan &argument : plan->finish.arguments) {
+        if (argument.direction == GI_DIRECTION_OUT) {
+            continue;
+        }
+        if (plan->result_index < 0 && is_gio_type(argument, "AsyncResult")) {
+            plan->result_index = finish_this_offset + argument.in_index;
+        } else if (argument.js_index >= 0) {
+            // we wouldn't know what to pass for any other arguments
+            plan->result_index = -1;
+            break;
+        }
+    }
+
+    if (plan->callback_index < 0 || plan->result_index < 0) {
+        delete plan;
+        return nullptr;
+    }
+    return plan;
+}
+
+/**
+ * Creates the Promise returning prototype method of an _async method. It takes the
+ * same arguments as the _async method without the callback and user_data.
+ */
+Local<FunctionTemplate> AsyncReadyCall::create_method(AsyncReadyPlan *plan) {
+    return Nan::New<FunctionTemplate>(AsyncReadyCall::invoke_method, Nan::New<External>((void *)plan));
+}
+
+/**
+ * Creates the fn.promise entry point. Like the other entry points
+ * (see GIRFunction::add_entry_points) methods take their instance as the first argument.
+ */
+Local<FunctionTemplate> AsyncReadyCall::create_entry_point(AsyncReadyPlan *plan) {
+    return Nan::New<FunctionTemplate>(AsyncReadyCall::invoke, Nan::New<External>((void *)plan));
+}
+
+// returns the GObject the _async method should be called on, or nullptr (with
+// a TypeError thrown) if js_instance isn't a wrapper of the method's class.
+GObject *AsyncReadyCall::get_instance(const AsyncReadyPlan &plan, Local<Value> js_instance, const char *description) {
+    GIRObject *gir_object = GIRObject::unwrap(js_instance, plan.start.instance_g_type);
+    if (gir_object == nullptr) {
+        string message = string(description) + " should be a " + g_type_name(plan.start.instance_g_type);
+        Nan::ThrowTypeError(message.c_str());
+        return nullptr;
+    }
+    return gir_object->get_gobject();
+}
+
+NAN_METHOD(AsyncReadyCall::invoke_method) {
+    AsyncReadyPlan *plan = (AsyncReadyPlan *)Local<External>::Cast(info.Data())->Value();
+    GObject *instance = AsyncReadyCall::get_instance(*plan, info.This(), "the value of 'this'");
+    if (instance != nullptr) {
+        AsyncReadyCall::start(info, *plan, instance, info.This(), 0);
+    }
+}
+
+NAN_METHOD(AsyncReadyCall::invoke) {
+    AsyncReadyPlan *plan = (AsyncReadyPlan *)Local<External>::Cast(info.Data())->Value();
+    if (!plan->start.is_method) {
+        AsyncReadyCall::start(info, *plan, nullptr, Nan::Undefined(), 0);
+        return;
+    }
+    Local<Value> js_instance = info.Length() > 0 ? info[0] : Local<Value>(Nan::Undefined());
+    GObject *instance = AsyncReadyCall::get_instance(*plan, js_instance, "the first argument");
+    if (instance != nullptr) {
+        AsyncReadyCall::start(info, *plan, instance, js_instance, 1);
+    }
+}
+
+// calls the _async function with the JS arguments from js_offset on
+// and returns a Promise for the result of the _finish function.
+void AsyncReadyCall::start(const Nan::FunctionCallbackInfo<Value> &info,
+                           const AsyncReadyPlan &plan,
+                           GObject *instance,
+                           Local<Value> js_instance,
+                           int js_offset) {
+    Local<Context> context = Nan::GetCurrentContext();
+    Local<Promise::Resolver> resolver = Promise::Resolver::New(context).ToLocalChecked();
+    AsyncReadyCall *async_call = new AsyncReadyCall(plan, Nan::New<Function>(settle_promise, resolver));
+
+    try {
+        async_call->args.load_js_arguments(info, js_offset);
+        if (plan.start.is_method) {
+            async_call->args.load_context(instance);
+        }
+        async_call->args.in[plan.callback_index].v_pointer = (gpointer)AsyncReadyCall::on_ready;
+        async_call->args.in[plan.user_data_index].v_pointer = async_call;
+        GIRFunction::call_native(plan.start, async_call->args);
+    } catch (exception &error) {
+        delete async_call;
+        resolver->Reject(context, Nan::Error(error.what())).FromJust();
+        info.GetReturnValue().Set(resolver->GetPromise());
+        return;
+    }
+
+    // keep the instance and the arguments (which the native arguments may point into)
+    // alive until the operation completes.
+    Local<Array> js_arguments = Nan::New<Array>(info.Length() + 1);
+    for (int i = 0; i < info.Length(); i++) {
+        Nan::Set(js_arguments, i, info[i]);
+    }
+    Nan::Set(js_arguments, info.Length(), js_instance);
+    async_call->js_arguments.Reset(js_arguments);
+
+    info.GetReturnValue().Set(resolver->GetPromise());
+}
+
+/**
+ * The GAsyncReadyCallback we give to _async functions. It runs on the main
+ * thread (from the GLib main loop) so it calls the _finish function and converts
+ * it's result straight away.
+ */
+void AsyncReadyCall::on_ready(GObject *source_object, GAsyncResult *result, gpointer user_data) {
+    AsyncReadyCall *async_call = static_cast<AsyncReadyCall *>(user_data);
+    const CallPlan &finish_plan = async_call->plan.finish;
+
+    Nan::HandleScope scope;
+    Local<Value> argv[] = {Nan::Null(), Nan::Undefined()};
+    try {
+        Args finish_args(finish_plan);
+        finish_args.load_out_arguments();
+        if (finish_plan.is_method) {
+            finish_args.load_context(source_object);
+        }
+        finish_args.in[async_call->plan.result_index].v_pointer = result;
+        GIArgument native_result = GIRFunction::call_native(finish_plan, finish_args);
+        argv[1] = GIRFunction::js_return_value_from_native_call(finish_plan, finish_args, native_result, nullptr);
+    } catch (exception &error) {
+        argv[0] = Nan::Error(error.what());
+    }
+
+    async_call->settle.Call(2, argv, &async_call->async_resource);
+    delete async_call;
+}
+
+} // namespace gir
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <girepository.h>
+#include <glib.h>
+#include <gio/gio.h>
+#include <nan.h>
+#include <v8.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "arguments.h"
+#include "call_plan.h"
+
+namespace gir {
+
+using namespace v8;
+
+/**
+ * Runs a native function on the libuv threadpool so that blocking calls
+ * (file IO, spawning processes, decoding images, etc) don't block the event loop.
+ * The JS arguments are converted on the JS thread before the call and the return
+ * value (and OUT arguments) are converted back on the JS thread afterwards.
+ * The result is passed to JS through a Promise.
+ * Only call functions this way if they're safe to call from another thread.
+ */
+class AsyncCall : public Nan::AsyncWorker {
+public:
+    static Local<Value> start(GObject *instance,
+                              const CallPlan &plan,
+                              const Nan::FunctionCallbackInfo<Value> &js_callback_info,
+                              int js_offset);
+
+    void Execute() override;
+
+protected:
+    void HandleOKCallback() override;
+
+private:
+    const CallPlan &plan;
+    Args args;
+    GIArgument result;
+
+    AsyncCall(const CallPlan &plan, Nan::Callback *settle);
+};
+
+/**
+ * Calls a native function over a batch of argument arrays on several threads of
+ * the libuv threadpool at once (see fn.parallel). Every call's arguments are converted
+ * up front on the JS thread, the batch is split into one chunk per CPU and the
+ * results are gathered into one array (resolved through a Promise) once every
+ * chunk is done. Only thread-safe functions can be called this way.
+ */
+class ParallelCall {
+public:
+    static Local<Value> start(const CallPlan &plan, Local<Array> batch);
+
+private:
+    class Chunk;
+
+    const CallPlan &plan;
+    std::vector<std::unique_ptr<Args>> calls;
+    std::vector<GIArgument> results;
+    std::vector<std::string> errors; // the error of each call, empty if it succeeded
+    int pending_chunks = 0;
+    // every JS value we converted (copied out of the batch, which JS can change while
+    // the calls run) because the native arguments may point into them.
+    Nan::Persistent<Array> js_values;
+
+    ParallelCall(const CallPlan &plan);
+    ~ParallelCall();
+
+    void run(size_t begin, size_t end);
+    Local<Value> gather_results();
+};
+
+/**
+ * The CallPlans of a GIO style _async/_finish function pair along with
+ * the positions (in Args::in) of the arguments we fill in natively.
+ */
+struct AsyncReadyPlan {
+    CallPlan start;
+    CallPlan finish;
+    int callback_index;  // the _async function's GAsyncReadyCallback
+    int user_data_index; // the callback's user_data or -1
+    int result_index;    // the _finish function's GAsyncResult
+
+    AsyncReadyPlan(GIFunctionInfo *start_info, GIFunctionInfo *finish_info) : start(start_info), finish(finish_info) {}
+};
+
+/**
+ * Bridges GIO style asynchronous functions (i.e. g_file_read_async/g_file_read_finish)
+ * to Promises. The _async function is called with a native GAsyncReadyCallback that
+ * calls the _finish function and settles the Promise, so the operation completes
+ * without a JS closure (or a round trip through JS).
+ * Methods get a Promise returning prototype method next to the callback one
+ * e.g. `const stream = await file.readPromise(GLib.PRIORITY_DEFAULT, null)`
+ * and, like the other entry points, fn.promise which takes the instance first.
+ * The Promise is settled from the GLib main loop but, like any Promise, it's reactions
+ * only run once the native code on the stack returns. They run straight away when the
+ * GLib loop is the one driving libuv (see start_loop) but not while a JS call to
+ * loop.run() is on the stack, so don't quit a nested loop from a reaction.
+ */
+class AsyncReadyCall {
+public:
+    static AsyncReadyPlan *create_plan(GIFunctionInfo *start_info, GIFunctionInfo *finish_info);
+    static Local<FunctionTemplate> create_method(AsyncReadyPlan *plan);
+    static Local<FunctionTemplate> create_entry_point(AsyncReadyPlan *plan);
+
+private:
+    const AsyncReadyPlan &plan;
+    Args args; // the _async function's arguments live until the operation completes
+    Nan::Callback settle;
+    Nan::AsyncResource async_resource;
+    Nan::Persistent<Object> js_arguments;
+
+    AsyncReadyCall(const AsyncReadyPlan &plan, Local<Function> settle);
+    ~AsyncReadyCall();
+
+    static GObject *get_instance(const AsyncReadyPlan &plan, Local<Value> js_instance, const char *description);
+    static void start(const Nan::FunctionCallbackInfo<Value> &info,
+                      const AsyncReadyPlan &plan,
+                      GObject *instance,
+                      Local<Value> js_instance,
+                      int js_offset);
+    static void on_ready(GObject *source_object, GAsyncResult *result, gpointer user_data);
+    static NAN_METHOD(invoke_method);
+    static NAN_METHOD(invoke);
+};
+
+} // namespace gir
@@ -0,0 +1,170 @@
+#include "call_plan.h"
+
+namespace gir {
+
+CallPlan::CallPlan(GICallableInfo *callable_info) : callable_info(g_base_info_ref(callable_info)) {
+    this->is_method = g_callable_info_is_method(callable_info);
+    this->instance_g_type = G_TYPE_NONE;
+    if (this->is_method) {
+        // the container is borrowed, we don't unref it
+        GIBaseInfo *container_info = g_base_info_get_container(callable_info);
+        if (container_info != nullptr && GI_IS_REGISTERED_TYPE_INFO(container_info)) {
+            this->instance_g_type = g_registered_type_info_get_g_type(container_info);
+        }
+    }
+    this->can_throw = g_callable_info_can_throw_gerror(callable_info);
+    this->n_in = 0;
+    this->n_out = 0;
+
+    // load the return type information
+    g_callable_info_load_return_type(callable_info, &this->return_type_info);
+    this->return_tag = g_type_info_get_tag(&this->return_type_info);
+    this->return_transfer = g_callable_info_get_caller_owns(callable_info);
+    if (this->return_tag == GI_TYPE_TAG_INTERFACE) {
+        this->return_interface_info = GIRInfoUniquePtr(g_type_info_get_interface(&this->return_type_info));
+    }
+    this->return_array_length_index = CallPlan::get_array_length_index(&this->return_type_info, this->return_tag);
+    this->skip_return = g_callable_info_skip_return(callable_info) || this->return_tag == GI_TYPE_TAG_VOID;
+
+    // load every argument's information. The GIArgInfo and GITypeInfo are loaded
+    // directly into the vector's storage (which we reserve up front so it never
+    // moves) because the GITypeInfo keeps a pointer to it's container GIArgInfo.
+    int n_args = g_callable_info_get_n_args(callable_info);
+    this->arguments.reserve(n_args);
+    for (int i = 0; i < n_args; i++) {
+        this->arguments.emplace_back();
+        ArgumentPlan &argument = this->arguments.back();
+
+        g_callable_info_load_arg(callable_info, i, &argument.arg_info);
+        g_arg_info_load_type(&argument.arg_info, &argument.type_info);
+        argument.direction = g_arg_info_get_direction(&argument.arg_info);
+        argument.type_tag = g_type_info_get_tag(&argument.type_info);
+        argument.transfer = g_arg_info_get_ownership_transfer(&argument.arg_info);
+        argument.may_be_null = g_arg_info_may_be_null(&argument.arg_info);
+        argument.caller_allocates = g_arg_info_is_caller_allocates(&argument.arg_info);
+
+        argument.interface_type = GI_INFO_TYPE_INVALID;
+        if (argument.type_tag == GI_TYPE_TAG_INTERFACE) {
+            argument.interface_info = GIRInfoUniquePtr(g_type_info_get_interface(&argument.type_info));
+            argument.interface_type = g_base_info_get_type(argument.interface_info.get());
+        }
+        argument.caller_allocates_size = CallPlan::get_caller_allocates_size(argument);
+        argument.array_length_index = CallPlan::get_array_length_index(&argument.type_info, argument.type_tag);
+        argument.is_array_length = false;
+
+        argument.js_index = 0;
+        argument.in_index = -1;
+        argument.out_index = -1;
+        if (argument.direction == GI_DIRECTION_IN || argument.direction == GI_DIRECTION_INOUT) {
+            argument.in_index = this->n_in++;
+        }
+        if (argument.direction == GI_DIRECTION_OUT || argument.direction == GI_DIRECTION_INOUT) {
+            argument.out_index = this->n_out++;
+        }
+    }
+
+    // now that we know about every argument we can mark the ones that are array lengths
+    if (this->return_array_length_index >= 0 && this->return_array_length_index < n_args) {
+        this->arguments[this->return_array_length_index].is_array_length = true;
+    }
+    for (ArgumentPlan &argument : this->arguments) {
+        if (argument.array_length_index >= 0 && argument.array_length_index < n_args) {
+            this->arguments[argument.array_length_index].is_array_length = true;
+        }
+    }
+
+    // work out where each argument comes from in the JS function call. The lengths of
+    // IN arrays aren't passed from JS (Args fills them in). OUT arguments keep their
+    // position, as they always have, but whatever JS passes for them is ignored.
+    for (ArgumentPlan &argument : this->arguments) {
+        if (argument.direction != GI_DIRECTION_OUT && argument.array_length_index >= 0 &&
+            argument.array_length_index < n_args) {
+            this->arguments[argument.array_length_index].js_index = -1;
+        }
+    }
+    int n_js_args = 0;
+    for (ArgumentPlan &argument : this->arguments) {
+        if (argument.js_index >= 0) {
+            argument.js_index = n_js_args++;
+        }
+    }
+
+    // and work out where each OUT argument goes in the values we return to JS
+    this->n_out_results = 0;
+    for (ArgumentPlan &argument : this->arguments) {
+        argument.result_index = -1;
+        if (argument.out_index >= 0 && !argument.is_array_length) {
+            argument.result_index = this->n_out_results++;
+        }
+    }
+
+    this->prepare_invoker();
+}
+
+/**
+ * Stops an argument from being passed from JS, whoever calls the native function
+ * is responsible for setting it's value in Args::in (i.e. the GAsyncReadyCallback
+ * of an _async function, see AsyncReadyCall). The JS arguments after it move
+ * down one position.
+ */
+void CallPlan::skip_js_argument(int argument_index) {
+    ArgumentPlan &skipped_argument = this->arguments[argument_index];
+    if (skipped_argument.js_index < 0) {
+        return;
+    }
+    for (ArgumentPlan &argument : this->arguments) {
+        if (argument.js_index > skipped_argument.js_index) {
+            argument.js_index--;
+        }
+    }
+    skipped_argument.js_index = -1;
+}
+
+CallPlan::~CallPlan() {
+    if (this->invoker_ready) {
+        g_function_invoker_destroy(&this->invoker);
+    }
+}
+
+/**
+ * Resolves the native function's symbol and prepares it's ffi_cif once so
+ * that GIRFunction::call_native can go straight to ffi_call() rather than
+ * doing both on every call (which is what g_function_info_invoke does).
+ */
+void CallPlan::prepare_invoker() {
+    this->invoker_ready = false;
+    if (!GI_IS_FUNCTION_INFO(this->callable_info.get())) {
+        this->invoker_error = "only functions can be invoked";
+        return;
+    }
+
+    GError *error = nullptr;
+    if (g_function_info_prep_invoker(this->callable_info.get(), &this->invoker, &error)) {
+        this->invoker_ready = true;
+    } else {
+        this->invoker_error = string(error->message);
+        g_error_free(error);
+    }
+}
+
+gsize CallPlan::get_caller_allocates_size(ArgumentPlan &argument) {
+    if (!argument.caller_allocates || argument.type_tag != GI_TYPE_TAG_INTERFACE) {
+        return 0;
+    }
+    if (argument.interface_type == GI_INFO_TYPE_STRUCT) {
+        return g_struct_info_get_size((GIStructInfo *)argument.interface_info.get());
+    }
+    if (argument.interface_type == GI_INFO_TYPE_UNION) {
+        return g_union_info_get_size((GIUnionInfo *)argument.interface_info.get());
+    }
+    return 0;
+}
+
+int CallPlan::get_array_length_index(GITypeInfo *type_info, GITypeTag type_tag) {
+    if (type_tag != GI_TYPE_TAG_ARRAY || g_type_info_get_array_type(type_info) != GI_ARRAY_TYPE_C) {
+        return -1;
+    }
+    return g_type_info_get_array_length(type_info);
+}
+
+} // namespace gir
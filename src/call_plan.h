@@ -0,0 +1,99 @@
+#pragma once
+
+#include <girepository.h>
+#include <girffi.h>
+#include <glib.h>
+#include <string>
+#include <vector>
+#include "util.h"
+
+namespace gir {
+
+using namespace std;
+
+/**
+ * Everything we need to know about one argument of a native function in order
+ * to marshal it. It's read from the GI metadata once (when the function is
+ * bound) rather than on every call.
+ */
+struct ArgumentPlan {
+    // these are mutable because the GI API takes non-const pointers,
+    // even for functions that only read from the info.
+    mutable GIArgInfo arg_info;
+    mutable GITypeInfo type_info;
+    GIDirection direction;
+    GITypeTag type_tag;
+    GITransfer transfer;
+    bool may_be_null;
+    bool caller_allocates;
+
+    // the argument's interface info (and it's type) when type_tag is
+    // GI_TYPE_TAG_INTERFACE, otherwise nullptr and GI_INFO_TYPE_INVALID.
+    GIRInfoUniquePtr interface_info;
+    GIInfoType interface_type;
+
+    // the size of the memory we need to allocate for caller-allocates
+    // OUT arguments. 0 if the argument isn't caller-allocates or if we
+    // don't know how to allocate the argument's type.
+    gsize caller_allocates_size;
+
+    // for C arrays, the index of the argument that holds the array's length or -1
+    int array_length_index;
+    // true if this argument is the length of another argument's (or the return value's) array.
+    // OUT length arguments aren't passed back to JS because the array already has a length.
+    bool is_array_length;
+
+    int js_index;     // the position of the argument in the JS function call or -1 if it isn't passed from JS
+    int in_index;     // the position of the argument in Args::in or -1 if it's an OUT argument
+    int out_index;    // the position of the argument in Args::out or -1 if it's an IN argument
+    int result_index; // the position of the OUT argument in the values returned to JS or -1
+};
+
+/**
+ * A CallPlan is the precompiled description of a native function call.
+ * GIRFunction builds one per GIFunctionInfo when the function is bound and
+ * both Args (JS -> native) and GIRFunction (native -> JS) marshal from it.
+ */
+class CallPlan {
+public:
+    GIRInfoUniquePtr callable_info;
+    vector<ArgumentPlan> arguments;
+
+    bool is_method;
+    // the GType of the class (or struct) a method belongs to, otherwise G_TYPE_NONE
+    GType instance_g_type;
+    bool can_throw;
+    int n_in;          // number of IN and INOUT arguments, not including 'this'
+    int n_out;         // number of OUT and INOUT arguments
+    int n_out_results; // number of OUT and INOUT arguments that are passed back to JS
+
+    mutable GITypeInfo return_type_info;
+    GITypeTag return_tag;
+    GITransfer return_transfer;
+    GIRInfoUniquePtr return_interface_info;
+    int return_array_length_index; // see ArgumentPlan::array_length_index
+
+    // true when the native return value shouldn't be passed back to JS
+    // i.e. it's void or the GI metadata tells us to skip it.
+    bool skip_return;
+
+    // the prepared ffi_cif and resolved symbol of the native function.
+    // if the invoker couldn't be prepared (i.e. the symbol is missing from the
+    // library) then invoker_ready is false and invoker_error says why.
+    mutable GIFunctionInvoker invoker;
+    bool invoker_ready;
+    string invoker_error;
+
+    CallPlan(GICallableInfo *callable_info);
+    ~CallPlan();
+    void skip_js_argument(int argument_index);
+    CallPlan(const CallPlan &) = delete;
+    CallPlan &operator=(const CallPlan &) = delete;
+
+private:
+    void prepare_invoker();
+    static gsize get_caller_allocates_size(ArgumentPlan &argument);
+    static int get_array_length_index(GITypeInfo *type_info, GITypeTag type_tag);
+};
+
+} // namespace gir
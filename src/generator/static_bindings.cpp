@@ -0,0 +1,296 @@
+#include <girepository.h>
+#include <glib.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "util.h"
+
+/**
+ * Generates the C++ source of the optional girepository_static addon (see binding.gyp).
+ * usage: generate_static_bindings <output.cpp> <namespace>[-<version>][:<symbol>,<symbol>...]...
+ * e.g. generate_static_bindings static_bindings.cpp GLib-2.0:g_spaced_primes_closest Gio
+ *
+ * Every namespace level function (or just the listed C symbols) whose arguments and
+ * return value are primitives gets a binding that converts it's arguments with the
+ * types known at build time and calls the native symbol directly. The addon is
+ * linked against the namespace's libraries so nothing is looked up in the typelib
+ * at runtime. load() uses these bindings in place of the introspected functions
+ * (see src/addon.js). Functions we can't bind statically are left to the regular addon.
+ */
+
+using namespace std;
+
+// the C type a primitive is declared with and how it's converted to and from JS.
+// we don't include the namespace's headers (enums would conflict with the 'int'
+// we declare them as) so the C types must match the glib typedefs exactly.
+struct PrimitiveType {
+    string c_type;
+    string from_js; // reads a JS value, '$' is replaced with the value
+    string to_js;   // converts a native value, '$' is replaced with the value
+};
+
+struct NamespaceSelection {
+    string name;
+    string version;         // empty for the latest version
+    vector<string> symbols; // empty for every function
+};
+
+static string substitute(const string &format, const string &value) {
+    string result = format;
+    size_t position = result.find('$');
+    if (position != string::npos) {
+        result.replace(position, 1, value);
+    }
+    return result;
+}
+
+static bool get_primitive_type(GITypeInfo *type_info, PrimitiveType *type) {
+    if (g_type_info_is_pointer(type_info)) {
+        return false;
+    }
+    GITypeTag tag = g_type_info_get_tag(type_info);
+    if (tag == GI_TYPE_TAG_INTERFACE) {
+        // enums and flags are passed as ints, just like Args does
+        GIBaseInfo *interface_info = g_type_info_get_interface(type_info);
+        GIInfoType interface_type = g_base_info_get_type(interface_info);
+        tag = GI_TYPE_TAG_VOID;
+        if (interface_type == GI_INFO_TYPE_ENUM || interface_type == GI_INFO_TYPE_FLAGS) {
+            tag = g_enum_info_get_storage_type((GIEnumInfo *)interface_info);
+        }
+        g_base_info_unref(interface_info);
+    }
+
+    switch (tag) {
+        case GI_TYPE_TAG_BOOLEAN:
+            *type = {"int", "$->BooleanValue()", "Nan::New<v8::Boolean>($ != 0)"};
+            return true;
+        case GI_TYPE_TAG_INT8:
+            *type = {"signed char", "(signed char)$->Int32Value()", "Nan::New<v8::Int32>($)"};
+            return true;
+        case GI_TYPE_TAG_UINT8:
+            *type = {"unsigned char", "(unsigned char)$->Uint32Value()", "Nan::New<v8::Uint32>($)"};
+            return true;
+        case GI_TYPE_TAG_INT16:
+            *type = {"short", "(short)$->Int32Value()", "Nan::New<v8::Int32>($)"};
+            return true;
+        case GI_TYPE_TAG_UINT16:
+            *type = {"unsigned short", "(unsigned short)$->Uint32Value()", "Nan::New<v8::Uint32>($)"};
+            return true;
+        case GI_TYPE_TAG_INT32:
+            *type = {"int", "$->Int32Value()", "Nan::New<v8::Int32>($)"};
+            return true;
+        case GI_TYPE_TAG_UINT32:
+        case GI_TYPE_TAG_UNICHAR:
+            *type = {"unsigned int", "$->Uint32Value()", "Nan::New<v8::Uint32>($)"};
+            return true;
+        case GI_TYPE_TAG_FLOAT:
+            *type = {"float", "(float)$->NumberValue()", "Nan::New<v8::Number>($)"};
+            return true;
+        case GI_TYPE_TAG_DOUBLE:
+            *type = {"double", "$->NumberValue()", "Nan::New<v8::Number>($)"};
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * writes the binding for a function and returns true, or returns false
+ * (without writing anything) if the function can't be bound statically.
+ */
+static bool generate_function(GIFunctionInfo *function_info, ostream &declarations, ostream &bindings) {
+    GIFunctionInfoFlags flags = g_function_info_get_flags(function_info);
+    if ((flags & GI_FUNCTION_IS_METHOD) || (flags & GI_FUNCTION_THROWS)) {
+        return false;
+    }
+
+    GITypeInfo return_type_info;
+    g_callable_info_load_return_type(function_info, &return_type_info);
+    bool returns_void = g_type_info_get_tag(&return_type_info) == GI_TYPE_TAG_VOID &&
+                        !g_type_info_is_pointer(&return_type_info);
+    PrimitiveType return_type = {"void", "", ""};
+    if (!returns_void && !get_primitive_type(&return_type_info, &return_type)) {
+        return false;
+    }
+
+    int n_arguments = g_callable_info_get_n_args(function_info);
+    vector<PrimitiveType> argument_types(n_arguments);
+    for (int i = 0; i < n_arguments; i++) {
+        GIArgInfo arg_info;
+        GITypeInfo type_info;
+        g_callable_info_load_arg(function_info, i, &arg_info);
+        g_arg_info_load_type(&arg_info, &type_info);
+        if (g_arg_info_get_direction(&arg_info) != GI_DIRECTION_IN ||
+            !get_primitive_type(&type_info, &argument_types[i])) {
+            return false;
+        }
+    }
+
+    string symbol = g_function_info_get_symbol(function_info);
+    // the same name NamespaceLoader exports the introspected function as
+    string js_name = gir::Util::base_info_canonical_name(function_info);
+
+    declarations << return_type.c_type << " " << symbol << "(";
+    for (int i = 0; i < n_arguments; i++) {
+        declarations << (i > 0 ? ", " : "") << argument_types[i].c_type;
+    }
+    declarations << (n_arguments == 0 ? "void" : "") << ");\n";
+
+    bindings << "static NAN_METHOD(bind_" << symbol << ") {\n";
+    for (int i = 0; i < n_arguments; i++) {
+        bindings << "    if (info[" << i << "]->IsNullOrUndefined()) {\n"
+                 << "        Nan::ThrowTypeError(\"argument " << i << " of " << js_name
+                 << " can't be null or undefined\");\n"
+                 << "        return;\n"
+                 << "    }\n";
+    }
+    stringstream call;
+    call << symbol << "(";
+    for (int i = 0; i < n_arguments; i++) {
+        call << (i > 0 ? ", " : "") << substitute(argument_types[i].from_js, "info[" + to_string(i) + "]");
+    }
+    call << ")";
+    if (returns_void) {
+        bindings << "    " << call.str() << ";\n";
+    } else {
+        bindings << "    " << return_type.c_type << " result = " << call.str() << ";\n"
+                 << "    info.GetReturnValue().Set(" << substitute(return_type.to_js, "result") << ");\n";
+    }
+    bindings << "}\n\n";
+    return true;
+}
+
+static bool generate_namespace(const NamespaceSelection &selection,
+                               ostream &declarations,
+                               ostream &bindings,
+                               ostream &registrations) {
+    GIRepository *repository = g_irepository_get_default();
+    GError *error = nullptr;
+    const char *version = selection.version.empty() ? nullptr : selection.version.c_str();
+    g_irepository_require(repository, selection.name.c_str(), version, (GIRepositoryLoadFlags)0, &error);
+    if (error != nullptr) {
+        cerr << "generate_static_bindings: " << error->message << endl;
+        g_error_free(error);
+        return false;
+    }
+
+    string namespace_variable = "namespace_" + selection.name;
+    registrations << "    v8::Local<v8::Object> " << namespace_variable << " = Nan::New<v8::Object>();\n"
+                  << "    v8::Local<v8::Object> " << namespace_variable << "_functions = Nan::New<v8::Object>();\n"
+                  << "    Nan::Set(" << namespace_variable << ", Nan::New(\"version\").ToLocalChecked(), Nan::New(\""
+                  << g_irepository_get_version(repository, selection.name.c_str()) << "\").ToLocalChecked());\n"
+                  << "    Nan::Set(" << namespace_variable << ", Nan::New(\"functions\").ToLocalChecked(), "
+                  << namespace_variable << "_functions);\n";
+
+    int n_infos = g_irepository_get_n_infos(repository, selection.name.c_str());
+    for (int i = 0; i < n_infos; i++) {
+        GIBaseInfo *info = g_irepository_get_info(repository, selection.name.c_str(), i);
+        if (g_base_info_get_type(info) == GI_INFO_TYPE_FUNCTION) {
+            string symbol = g_function_info_get_symbol(info);
+            bool is_selected = selection.symbols.empty();
+            for (const string &selected_symbol : selection.symbols) {
+                is_selected = is_selected || selected_symbol == symbol;
+            }
+            if (is_selected && generate_function(info, declarations, bindings)) {
+                registrations << "    Nan::SetMethod(" << namespace_variable << "_functions, \""
+                              << gir::Util::base_info_canonical_name(info) << "\", bind_" << symbol << ");\n";
+            } else if (!selection.symbols.empty() && is_selected) {
+                cerr << "generate_static_bindings: " << symbol << " can't be bound statically, skipping it" << endl;
+            }
+        }
+        g_base_info_unref(info);
+    }
+
+    registrations << "    Nan::Set(target, Nan::New(\"" << selection.name << "\").ToLocalChecked(), "
+                  << namespace_variable << ");\n";
+    return true;
+}
+
+// parses <namespace>[-<version>][:<symbol>,<symbol>...]
+static NamespaceSelection parse_selection(const string &argument) {
+    NamespaceSelection selection;
+    string name = argument;
+    size_t symbols_start = argument.find(':');
+    if (symbols_start != string::npos) {
+        name = argument.substr(0, symbols_start);
+        stringstream symbols(argument.substr(symbols_start + 1));
+        string symbol;
+        while (getline(symbols, symbol, ',')) {
+            if (!symbol.empty()) {
+                selection.symbols.push_back(symbol);
+            }
+        }
+    }
+    size_t version_start = name.find('-');
+    selection.name = name.substr(0, version_start);
+    if (version_start != string::npos) {
+        selection.version = name.substr(version_start + 1);
+    }
+    return selection;
+}
+
+// adds a selection to the ones we've parsed, merging it with an earlier selection of the
+// same namespace (each namespace is generated once). Returns false if their versions differ.
+static bool add_selection(vector<NamespaceSelection> &selections, const NamespaceSelection &selection) {
+    for (NamespaceSelection &existing : selections) {
+        if (existing.name != selection.name) {
+            continue;
+        }
+        if (!existing.version.empty() && !selection.version.empty() && existing.version != selection.version) {
+            cerr << "generate_static_bindings: " << selection.name << " is selected with versions "
+                 << existing.version << " and " << selection.version << endl;
+            return false;
+        }
+        if (existing.version.empty()) {
+            existing.version = selection.version;
+        }
+        if (existing.symbols.empty() || selection.symbols.empty()) {
+            // one of them selects every function
+            existing.symbols.clear();
+        } else {
+            existing.symbols.insert(existing.symbols.end(), selection.symbols.begin(), selection.symbols.end());
+        }
+        return true;
+    }
+    selections.push_back(selection);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        cerr << "usage: generate_static_bindings <output.cpp> <namespace>[-<version>][:<symbol>,<symbol>...]..."
+             << endl;
+        return 1;
+    }
+
+    vector<NamespaceSelection> selections;
+    for (int i = 2; i < argc; i++) {
+        if (!add_selection(selections, parse_selection(argv[i]))) {
+            return 1;
+        }
+    }
+
+    stringstream declarations;
+    stringstream bindings;
+    stringstream registrations;
+    for (const NamespaceSelection &selection : selections) {
+        if (!generate_namespace(selection, declarations, bindings, registrations)) {
+            return 1;
+        }
+    }
+
+    ofstream output(argv[1]);
+    output << "// generated by generate_static_bindings (src/generator/static_bindings.cpp), don't edit it!\n"
+           << "#include <nan.h>\n\n"
+           << "extern \"C\" {\n"
+           << declarations.str() << "}\n\n"
+           << "namespace gir_static {\n\n"
+           << bindings.str() << "NAN_MODULE_INIT(init) {\n"
+           << registrations.str() << "}\n\n"
+           << "} // namespace gir_static\n\n"
+           << "NODE_MODULE(girepository_static, gir_static::init)\n";
+    output.close();
+    return output.fail() ? 1 : 0;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <glib.h>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include "InlineVector.h"
+
+namespace gir {
+
+/**
+ * A scratch allocator for the temporaries we create while marshalling a
+ * single native call (strings, GValues, caller-allocated structs, etc).
+ * Small allocations come out of a block stored inside the Arena itself and
+ * everything (including any cleanup functions that have been registered) is
+ * released in one step when the Arena is destroyed.
+ *
+ * Memory handed out by an Arena must not outlive it. Anything that has to
+ * (i.e. because the native function takes ownership of it or because it's
+ * handed to JS) must be copied out of the arena.
+ */
+class Arena {
+public:
+    Arena() = default;
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    ~Arena() {
+        this->release();
+    }
+
+    /**
+     * returns 'size' bytes of zero initialized memory that lives as long as the arena.
+     */
+    void *allocate(size_t size) {
+        size = Arena::align(size);
+        if (this->used + size > this->block_size) {
+            this->grow(size);
+        }
+        char *memory = this->block + this->used;
+        this->used += size;
+        memset(memory, 0, size);
+        return memory;
+    }
+
+    /**
+     * copies 'length' bytes of 'string' into the arena and null terminates the copy.
+     */
+    char *copy_string(const char *string, size_t length) {
+        char *copy = static_cast<char *>(this->allocate(length + 1));
+        memcpy(copy, string, length);
+        copy[length] = '\0';
+        return copy;
+    }
+
+    /**
+     * registers a function that will be called with 'data' when the arena is released.
+     * cleanups are run in the reverse order they were added.
+     */
+    void add_cleanup(GDestroyNotify destroy, gpointer data) {
+        Cleanup cleanup = {destroy, data};
+        this->cleanups.push_back(cleanup);
+    }
+
+    /**
+     * runs all registered cleanups and frees every block the arena allocated.
+     * the arena can be reused afterwards.
+     */
+    void release() {
+        for (size_t i = this->cleanups.size(); i > 0; i--) {
+            Cleanup &cleanup = this->cleanups[i - 1];
+            cleanup.destroy(cleanup.data);
+        }
+        this->cleanups.clear();
+        for (void *heap_block : this->heap_blocks) {
+            free(heap_block);
+        }
+        this->heap_blocks.clear();
+        this->block = this->inline_block;
+        this->block_size = INLINE_BLOCK_SIZE;
+        this->used = 0;
+    }
+
+private:
+    static const size_t INLINE_BLOCK_SIZE = 256;
+    static const size_t MIN_HEAP_BLOCK_SIZE = 4096;
+    static const size_t ALIGNMENT = 16;
+
+    struct Cleanup {
+        GDestroyNotify destroy;
+        gpointer data;
+    };
+
+    alignas(ALIGNMENT) char inline_block[INLINE_BLOCK_SIZE];
+    char *block = inline_block;
+    size_t block_size = INLINE_BLOCK_SIZE;
+    size_t used = 0;
+    InlineVector<void *, 4> heap_blocks;
+    InlineVector<Cleanup, 4> cleanups;
+
+    static size_t align(size_t size) {
+        return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    void grow(size_t size) {
+        size_t new_block_size = size > MIN_HEAP_BLOCK_SIZE ? size : MIN_HEAP_BLOCK_SIZE;
+        // malloc's alignment is good enough for anything we store in the arena
+        char *new_block = static_cast<char *>(malloc(new_block_size));
+        if (new_block == nullptr) {
+            throw std::bad_alloc();
+        }
+        this->heap_blocks.push_back(new_block);
+        this->block = new_block;
+        this->block_size = new_block_size;
+        this->used = 0;
+    }
+};
+
+} // namespace gir
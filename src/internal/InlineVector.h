@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+namespace gir {
+
+/**
+ * A vector for plain old data (GIArgument, pointers, etc) that keeps up to
+ * InlineCapacity elements inside the object itself. It only allocates on the
+ * heap if it grows past that, so a stack allocated InlineVector that stays
+ * within it's inline capacity never touches malloc/free.
+ */
+template<class T, size_t InlineCapacity>
+class InlineVector {
+    static_assert(std::is_pod<T>::value, "InlineVector can only hold plain old data");
+    static_assert(InlineCapacity > 0, "InlineVector needs room for at least 1 inline element");
+
+public:
+    InlineVector() = default;
+
+    InlineVector(const InlineVector &other) {
+        this->resize(other.length);
+        memcpy(this->elements, other.elements, other.length * sizeof(T));
+    }
+
+    InlineVector &operator=(const InlineVector &other) {
+        if (this != &other) {
+            this->resize(other.length);
+            memcpy(this->elements, other.elements, other.length * sizeof(T));
+        }
+        return *this;
+    }
+
+    ~InlineVector() {
+        if (this->elements != this->inline_elements) {
+            free(this->elements);
+        }
+    }
+
+    /**
+     * makes sure there's room for 'new_capacity' elements, moving them to
+     * the heap if that's more than we can store inline.
+     */
+    void reserve(size_t new_capacity) {
+        if (new_capacity <= this->capacity) {
+            return;
+        }
+        T *new_elements = static_cast<T *>(malloc(new_capacity * sizeof(T)));
+        if (new_elements == nullptr) {
+            throw std::bad_alloc();
+        }
+        memcpy(new_elements, this->elements, this->length * sizeof(T));
+        if (this->elements != this->inline_elements) {
+            free(this->elements);
+        }
+        this->elements = new_elements;
+        this->capacity = new_capacity;
+    }
+
+    /**
+     * resizes the vector, new elements are zero initialized.
+     */
+    void resize(size_t new_length) {
+        this->reserve(new_length);
+        if (new_length > this->length) {
+            memset(this->elements + this->length, 0, (new_length - this->length) * sizeof(T));
+        }
+        this->length = new_length;
+    }
+
+    void push_back(const T &element) {
+        if (this->length == this->capacity) {
+            this->reserve(this->capacity * 2);
+        }
+        this->elements[this->length++] = element;
+    }
+
+    void clear() {
+        this->length = 0;
+    }
+
+    T &operator[](size_t index) {
+        return this->elements[index];
+    }
+
+    const T &operator[](size_t index) const {
+        return this->elements[index];
+    }
+
+    T *data() {
+        return this->elements;
+    }
+
+    size_t size() const {
+        return this->length;
+    }
+
+    T *begin() {
+        return this->elements;
+    }
+
+    T *end() {
+        return this->elements + this->length;
+    }
+
+private:
+    T inline_elements[InlineCapacity];
+    T *elements = inline_elements;
+    size_t length = 0;
+    size_t capacity = InlineCapacity;
+};
+
+} // namespace gir
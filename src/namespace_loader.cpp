@@ -18,18 +18,28 @@ NAN_METHOD(NamespaceLoader::load) {
     if (!info[0]->IsString()) {
         Nan::ThrowError("argument has to be a string");
     }
+    // the options object is the last argument: load(namespace, [version], [options])
+    // - jsWrappers: wrap functions in generated JS that checks their arguments (see GIRFunction::prepare)
+    bool js_wrappers = false;
+    Local<Value> options = info[info.Length() - 1];
+    if (info.Length() > 1 && options->IsObject()) {
+        Local<Value> js_wrappers_option = Nan::Get(options.As<Object>(), Nan::New("jsWrappers").ToLocalChecked())
+                                              .ToLocalChecked();
+        js_wrappers = js_wrappers_option->IsTrue();
+    }
+
     Local<Value> exports;
     String::Utf8Value library_namespace(info[0]);
     if (info.Length() > 1 && info[1]->IsString()) {
         String::Utf8Value version(info[1]);
-        exports = NamespaceLoader::load_namespace(*library_namespace, *version);
+        exports = NamespaceLoader::load_namespace(*library_namespace, *version, js_wrappers);
     } else {
-        exports = NamespaceLoader::load_namespace(*library_namespace, nullptr);
+        exports = NamespaceLoader::load_namespace(*library_namespace, nullptr, js_wrappers);
     }
     info.GetReturnValue().Set(exports);
 }
 
-Local<Value> NamespaceLoader::load_namespace(const char *library_namespace, const char *version) {
+Local<Value> NamespaceLoader::load_namespace(const char *library_namespace, const char *version, bool js_wrappers) {
     auto repository = g_irepository_get_default();
     GError *error = nullptr;
     g_irepository_require(repository, library_namespace, version, (GIRepositoryLoadFlags)0, &error);
@@ -38,10 +48,10 @@ Local<Value> NamespaceLoader::load_namespace(const char *library_namespace, cons
         g_error_free(error);
         return Nan::Undefined();
     }
-    return NamespaceLoader::build_exports(library_namespace);
+    return NamespaceLoader::build_exports(library_namespace, js_wrappers);
 }
 
-Local<Value> NamespaceLoader::build_exports(const char *library_namespace) {
+Local<Value> NamespaceLoader::build_exports(const char *library_namespace, bool js_wrappers) {
     auto repository = g_irepository_get_default();
     Local<Object> module = Nan::New<Object>();
     Local<Value> exported_value = Nan::Null();
@@ -55,7 +65,7 @@ Local<Value> NamespaceLoader::build_exports(const char *library_namespace) {
                 exported_value = GIRObject::prepare(info.get());
                 break;
             case GI_INFO_TYPE_FUNCTION:
-                exported_value = GIRFunction::prepare(info.get());
+                exported_value = GIRFunction::prepare(info.get(), js_wrappers);
                 break;
             case GI_INFO_TYPE_BOXED:
             case GI_INFO_TYPE_STRUCT:
@@ -12,8 +12,8 @@ public:
     static NAN_METHOD(load);
 
 private:
-    static Local<Value> load_namespace(const char *library_namespace, const char *version);
-    static Local<Value> build_exports(const char *library_namespace);
+    static Local<Value> load_namespace(const char *library_namespace, const char *version, bool js_wrappers);
+    static Local<Value> build_exports(const char *library_namespace, bool js_wrappers);
 };
 
 } // namespace gir
@@ -0,0 +1,263 @@
+#include "trampolines.h"
+#include "types/object.h"
+
+#include <string>
+#include <unordered_map>
+
+namespace gir {
+
+using namespace std;
+
+constexpr char VoidKind::code;
+constexpr char Int32Kind::code;
+constexpr char UInt32Kind::code;
+constexpr char BooleanKind::code;
+constexpr char DoubleKind::code;
+
+// the most (non 'this') arguments a trampoline will take. Every combination of
+// parameter kinds up to this arity is instantiated so keep it small!
+static const int max_trampoline_arity = 3;
+
+struct TrampolineCallbacks {
+    Nan::FunctionCallback function;
+    Nan::FunctionCallback method;
+    Nan::FunctionCallback validated_function;
+};
+
+// trampolines are keyed by their signature code, i.e. the return kind's code
+// followed by each parameter kind's code. (ptr, i32) -> bool is "bi" and
+// (ptr, f64, f64) -> void is "vdd".
+using TrampolineRegistry = unordered_map<string, TrampolineCallbacks>;
+
+template<typename ReturnKind, typename... ParamKinds>
+static void register_trampoline(TrampolineRegistry &registry) {
+    string signature = {ReturnKind::code, ParamKinds::code...};
+    registry[signature] = {
+        Trampoline<ReturnKind, ParamKinds...>::invoke_function,
+        Trampoline<ReturnKind, ParamKinds...>::invoke_method,
+        Trampoline<ReturnKind, ParamKinds...>::invoke_validated,
+    };
+}
+
+template<typename... ParamKinds>
+static void register_signature(TrampolineRegistry &registry) {
+    register_trampoline<VoidKind, ParamKinds...>(registry);
+    register_trampoline<Int32Kind, ParamKinds...>(registry);
+    register_trampoline<UInt32Kind, ParamKinds...>(registry);
+    register_trampoline<BooleanKind, ParamKinds...>(registry);
+    register_trampoline<DoubleKind, ParamKinds...>(registry);
+}
+
+// registers a trampoline for every combination of parameter kinds
+// with up to 'Depth' more parameters than 'ParamKinds'.
+template<int Depth, typename... ParamKinds>
+struct SignatureEnumerator {
+    static void add(TrampolineRegistry &registry) {
+        register_signature<ParamKinds...>(registry);
+        SignatureEnumerator<Depth - 1, ParamKinds..., Int32Kind>::add(registry);
+        SignatureEnumerator<Depth - 1, ParamKinds..., UInt32Kind>::add(registry);
+        SignatureEnumerator<Depth - 1, ParamKinds..., BooleanKind>::add(registry);
+        SignatureEnumerator<Depth - 1, ParamKinds..., DoubleKind>::add(registry);
+    }
+};
+
+template<typename... ParamKinds>
+struct SignatureEnumerator<0, ParamKinds...> {
+    static void add(TrampolineRegistry &registry) {
+        register_signature<ParamKinds...>(registry);
+    }
+};
+
+static TrampolineRegistry &get_registry() {
+    static TrampolineRegistry registry;
+    if (registry.empty()) {
+        SignatureEnumerator<max_trampoline_arity>::add(registry);
+    }
+    return registry;
+}
+
+PersistentObjectStore<string, PersistentFunction> Trampolines::js_wrapper_factories;
+
+Nan::FunctionCallback Trampolines::find(const CallPlan &plan) {
+    string signature = Trampolines::get_signature(plan);
+    if (signature.empty()) {
+        return nullptr;
+    }
+    TrampolineRegistry &registry = get_registry();
+    auto trampoline = registry.find(signature);
+    if (trampoline == registry.end()) {
+        return nullptr;
+    }
+    return plan.is_method ? trampoline->second.method : trampoline->second.function;
+}
+
+/**
+ * Returns the signature code of the plan's trampoline (see TrampolineRegistry)
+ * or an empty string if the function can't be called through a trampoline.
+ */
+string Trampolines::get_signature(const CallPlan &plan) {
+    // trampolines only handle calls that can't fail natively and that
+    // have nothing to pass back to JS except the return value.
+    if (!plan.invoker_ready || plan.can_throw || plan.n_out > 0) {
+        return "";
+    }
+    if ((int)plan.arguments.size() > max_trampoline_arity) {
+        return "";
+    }
+    if (plan.skip_return && plan.return_tag != GI_TYPE_TAG_VOID) {
+        return "";
+    }
+
+    string signature;
+    if (plan.return_tag == GI_TYPE_TAG_VOID) {
+        signature.push_back(VoidKind::code);
+    } else {
+        signature.push_back(Trampolines::kind_code(plan.return_tag, plan.return_interface_info.get()));
+    }
+    for (const ArgumentPlan &argument : plan.arguments) {
+        signature.push_back(Trampolines::kind_code(argument.type_tag, argument.interface_info.get()));
+    }
+    if (signature.find('\0') != string::npos) {
+        return "";
+    }
+    return signature;
+}
+
+/**
+ * Creates a JS function that checks and coerces it's arguments in JS and then
+ * calls the native function through a trampoline that reads them without any
+ * type probing. Because the checks are plain JS, V8 can optimize them along with
+ * the caller. Calls with arguments that don't pass the checks go to 'fallback'
+ * (the regular function) so they behave exactly like they always have.
+ * Returns an empty handle if the function (or method) has no trampoline.
+ */
+Local<Function> Trampolines::create_js_wrapper(const CallPlan &plan,
+                                               Local<External> plan_extern,
+                                               Local<Function> fallback) {
+    string signature = plan.is_method ? "" : Trampolines::get_signature(plan);
+    if (signature.empty()) {
+        return Local<Function>();
+    }
+    TrampolineRegistry &registry = get_registry();
+    auto trampoline = registry.find(signature);
+    if (trampoline == registry.end()) {
+        return Local<Function>();
+    }
+
+    Local<Function> native_entry =
+        Nan::GetFunction(Nan::New<FunctionTemplate>(trampoline->second.validated_function, plan_extern))
+            .ToLocalChecked();
+    Local<Function> factory = Trampolines::get_js_wrapper_factory(signature.substr(1));
+    if (factory.IsEmpty()) {
+        return Local<Function>();
+    }
+    Local<Value> argv[] = {native_entry, fallback};
+    Local<Value> wrapper;
+    if (!Nan::Call(factory, Nan::GetCurrentContext()->Global(), 2, argv).ToLocal(&wrapper)) {
+        return Local<Function>();
+    }
+    return wrapper.As<Function>();
+}
+
+/**
+ * Returns a function that creates JS wrappers for functions with the given
+ * parameter kinds, compiling (and caching) it the first time it's needed.
+ * For (i32, f64) the wrapper is:
+ *   function (a0, a1) {
+ *     if (typeof a0 === 'number' && typeof a1 === 'number') return native(a0 | 0, a1);
+ *     return fallback.apply(this, arguments);
+ *   }
+ * The wrapper also gets the fallback's entry points (fn.async, fn.view, etc).
+ */
+Local<Function> Trampolines::get_js_wrapper_factory(const string &parameter_codes) {
+    if (Trampolines::js_wrapper_factories.exists(parameter_codes)) {
+        return Nan::New(Trampolines::js_wrapper_factories.at(parameter_codes));
+    }
+
+    string parameters;
+    string checks = "true";
+    string arguments;
+    for (size_t i = 0; i < parameter_codes.size(); i++) {
+        string name = "a" + to_string(i);
+        const char *js_type = parameter_codes[i] == BooleanKind::code ? "boolean" : "number";
+        const char *coercion = "";
+        if (parameter_codes[i] == Int32Kind::code) {
+            coercion = " | 0";
+        } else if (parameter_codes[i] == UInt32Kind::code) {
+            coercion = " >>> 0";
+        }
+        parameters += (i > 0 ? ", " : "") + name;
+        arguments += (i > 0 ? ", " : "") + name + coercion;
+        checks += " && typeof " + name + " === '" + js_type + "'";
+    }
+    string source = "(function (native, fallback) {\n"
+                    "  'use strict';\n"
+                    "  function wrapper(" + parameters + ") {\n"
+                    "    if (" + checks + ") return native(" + arguments + ");\n"
+                    "    return fallback.apply(this, arguments);\n"
+                    "  }\n"
+                    "  return Object.assign(wrapper, fallback);\n"
+                    "})";
+
+    Local<Value> factory;
+    Nan::MaybeLocal<Nan::BoundScript> script = Nan::CompileScript(Nan::New(source).ToLocalChecked());
+    if (script.IsEmpty() || !Nan::RunScript(script.ToLocalChecked()).ToLocal(&factory) || !factory->IsFunction()) {
+        return Local<Function>();
+    }
+    Trampolines::js_wrapper_factories.insert(make_pair(parameter_codes, PersistentFunction(factory.As<Function>())));
+    return factory.As<Function>();
+}
+
+/**
+ * Returns the code of the trampoline kind that can pass the given type
+ * or '\0' if there isn't one.
+ */
+char Trampolines::kind_code(GITypeTag tag, GIBaseInfo *interface_info) {
+    switch (tag) {
+        case GI_TYPE_TAG_BOOLEAN:
+            return BooleanKind::code;
+        case GI_TYPE_TAG_INT32:
+            return Int32Kind::code;
+        case GI_TYPE_TAG_UINT32:
+            return UInt32Kind::code;
+        case GI_TYPE_TAG_DOUBLE:
+            return DoubleKind::code;
+        case GI_TYPE_TAG_INTERFACE: {
+            // enums and flags are passed as ints (just like Args does) as long
+            // as they are stored as 32 bit integers.
+            GIInfoType interface_type = g_base_info_get_type(interface_info);
+            if (interface_type != GI_INFO_TYPE_ENUM && interface_type != GI_INFO_TYPE_FLAGS) {
+                return '\0';
+            }
+            GITypeTag storage_type = g_enum_info_get_storage_type((GIEnumInfo *)interface_info);
+            if (storage_type == GI_TYPE_TAG_INT32 || storage_type == GI_TYPE_TAG_UINT32) {
+                return Int32Kind::code;
+            }
+            return '\0';
+        }
+        default:
+            return '\0';
+    }
+}
+
+bool Trampolines::has_null_or_undefined(const Nan::FunctionCallbackInfo<Value> &info, int argc) {
+    for (int i = 0; i < argc; i++) {
+        if (info[i]->IsNullOrUndefined()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// returns the GObject a method was called on. If 'this' isn't a wrapper of the
+// method's class then a TypeError is thrown and nullptr returned.
+GObject *Trampolines::get_this_object(const CallPlan &plan, const Nan::FunctionCallbackInfo<Value> &info) {
+    GIRObject *that = GIRObject::unwrap(info.This(), plan.instance_g_type);
+    if (that == nullptr) {
+        Nan::ThrowTypeError((string("the value of 'this' should be a ") + g_type_name(plan.instance_g_type)).c_str());
+        return nullptr;
+    }
+    return that->get_gobject();
+}
+
+} // namespace gir
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <girepository.h>
+#include <glib.h>
+#include <nan.h>
+#include <v8.h>
+#include <cstddef>
+#include <string>
+#include "internal/PersistentObjectStore.h"
+#include "call_plan.h"
+#include "types/function.h"
+
+namespace gir {
+
+using namespace v8;
+
+/**
+ * The kinds of primitive values a trampoline can pass to or return from a
+ * native function. Each kind pairs the C type the native function is declared
+ * with and the JS conversions for that type. The conversions match what
+ * Args::type_to_g_type and Args::from_g_type do for the same type tags.
+ * from_validated_js is used when a JS wrapper has already checked and coerced
+ * the value (see Trampolines::create_js_wrapper) so it can be read without probing.
+ */
+struct VoidKind {
+    using c_type = void;
+    static constexpr char code = 'v';
+};
+
+struct Int32Kind {
+    using c_type = gint32;
+    static constexpr char code = 'i';
+    static c_type from_js(Local<Value> value) {
+        return value->Int32Value();
+    }
+    static c_type from_validated_js(Local<Value> value) {
+        return value.As<Int32>()->Value();
+    }
+    static Local<Value> to_js(c_type value) {
+        return Nan::New(value);
+    }
+};
+
+struct UInt32Kind {
+    using c_type = guint32;
+    static constexpr char code = 'u';
+    static c_type from_js(Local<Value> value) {
+        return value->Uint32Value();
+    }
+    static c_type from_validated_js(Local<Value> value) {
+        return value.As<Uint32>()->Value();
+    }
+    static Local<Value> to_js(c_type value) {
+        return Nan::New(value);
+    }
+};
+
+struct BooleanKind {
+    using c_type = gboolean;
+    static constexpr char code = 'b';
+    static c_type from_js(Local<Value> value) {
+        return value->ToBoolean()->Value();
+    }
+    static c_type from_validated_js(Local<Value> value) {
+        return value.As<Boolean>()->Value();
+    }
+    static Local<Value> to_js(c_type value) {
+        return Nan::New<Boolean>(value);
+    }
+};
+
+struct DoubleKind {
+    using c_type = gdouble;
+    static constexpr char code = 'd';
+    static c_type from_js(Local<Value> value) {
+        return value->NumberValue();
+    }
+    static c_type from_validated_js(Local<Value> value) {
+        return value.As<Number>()->Value();
+    }
+    static Local<Value> to_js(c_type value) {
+        return Nan::New(value);
+    }
+};
+
+// a (C++11 friendly) compile time list of indices used to expand
+// the JS arguments alongside a trampoline's parameter kinds.
+template<size_t... I>
+struct TrampolineIndices {};
+
+template<size_t N, size_t... I>
+struct MakeTrampolineIndices : MakeTrampolineIndices<N - 1, N - 1, I...> {};
+
+template<size_t... I>
+struct MakeTrampolineIndices<0, I...> {
+    using type = TrampolineIndices<I...>;
+};
+
+template<typename ReturnKind>
+struct TrampolineReturn {
+    template<typename NativeFunction, typename... CArguments>
+    static Local<Value> call(NativeFunction native_function, CArguments... c_arguments) {
+        return ReturnKind::to_js(native_function(c_arguments...));
+    }
+};
+
+template<>
+struct TrampolineReturn<VoidKind> {
+    template<typename NativeFunction, typename... CArguments>
+    static Local<Value> call(NativeFunction native_function, CArguments... c_arguments) {
+        native_function(c_arguments...);
+        return Nan::Undefined();
+    }
+};
+
+using PersistentFunction = Nan::Persistent<Function, CopyablePersistentTraits<Function>>;
+
+class Trampolines {
+public:
+    /**
+     * Returns a trampoline that can call the plan's native function directly
+     * or nullptr if the function's signature isn't one we have a trampoline for.
+     */
+    static Nan::FunctionCallback find(const CallPlan &plan);
+    static Local<Function> create_js_wrapper(const CallPlan &plan,
+                                             Local<External> plan_extern,
+                                             Local<Function> fallback);
+
+    static bool has_null_or_undefined(const Nan::FunctionCallbackInfo<Value> &info, int argc);
+    static GObject *get_this_object(const CallPlan &plan, const Nan::FunctionCallbackInfo<Value> &info);
+
+private:
+    // compiled JS wrapper factories, keyed by the parameter kind codes of their signature
+    static PersistentObjectStore<std::string, PersistentFunction> js_wrapper_factories;
+
+    static std::string get_signature(const CallPlan &plan);
+    static char kind_code(GITypeTag tag, GIBaseInfo *interface_info);
+    static Local<Function> get_js_wrapper_factory(const std::string &parameter_codes);
+};
+
+/**
+ * A Trampoline calls a native function whose signature only uses primitive
+ * types (and optionally a 'this' pointer) by casting the function's address
+ * to the matching C function pointer type. The argument conversions are picked
+ * at compile time so there's no per argument type dispatch and no libffi.
+ * Null or undefined arguments fall back to GIRFunction::call so that JS sees
+ * the same errors as the generic path.
+ */
+template<typename ReturnKind, typename... ParamKinds>
+class Trampoline {
+public:
+    using NativeFunction = typename ReturnKind::c_type (*)(typename ParamKinds::c_type...);
+    using NativeMethod = typename ReturnKind::c_type (*)(gpointer, typename ParamKinds::c_type...);
+    using Indices = typename MakeTrampolineIndices<sizeof...(ParamKinds)>::type;
+
+    static NAN_METHOD(invoke_function) {
+        CallPlan *plan = (CallPlan *)Local<External>::Cast(info.Data())->Value();
+        if (Trampolines::has_null_or_undefined(info, sizeof...(ParamKinds))) {
+            info.GetReturnValue().Set(GIRFunction::call(nullptr, *plan, info));
+            return;
+        }
+        NativeFunction native_function = reinterpret_cast<NativeFunction>(plan->invoker.native_address);
+        info.GetReturnValue().Set(Trampoline::call(native_function, info, Indices()));
+    }
+
+    static NAN_METHOD(invoke_method) {
+        CallPlan *plan = (CallPlan *)Local<External>::Cast(info.Data())->Value();
+        GObject *this_object = Trampolines::get_this_object(*plan, info);
+        if (this_object == nullptr) {
+            return;
+        }
+        if (Trampolines::has_null_or_undefined(info, sizeof...(ParamKinds))) {
+            info.GetReturnValue().Set(GIRFunction::call(this_object, *plan, info));
+            return;
+        }
+        NativeMethod native_method = reinterpret_cast<NativeMethod>(plan->invoker.native_address);
+        info.GetReturnValue().Set(Trampoline::call_method(native_method, this_object, info, Indices()));
+    }
+
+    // called by a JS wrapper that has already checked and coerced
+    // every argument (see Trampolines::create_js_wrapper)
+    static NAN_METHOD(invoke_validated) {
+        CallPlan *plan = (CallPlan *)Local<External>::Cast(info.Data())->Value();
+        NativeFunction native_function = reinterpret_cast<NativeFunction>(plan->invoker.native_address);
+        info.GetReturnValue().Set(Trampoline::call_validated(native_function, info, Indices()));
+    }
+
+private:
+    template<size_t... I>
+    static Local<Value> call(NativeFunction native_function,
+                             const Nan::FunctionCallbackInfo<Value> &info,
+                             TrampolineIndices<I...>) {
+        return TrampolineReturn<ReturnKind>::call(native_function, ParamKinds::from_js(info[I])...);
+    }
+
+    template<size_t... I>
+    static Local<Value> call_validated(NativeFunction native_function,
+                                       const Nan::FunctionCallbackInfo<Value> &info,
+                                       TrampolineIndices<I...>) {
+        return TrampolineReturn<ReturnKind>::call(native_function, ParamKinds::from_validated_js(info[I])...);
+    }
+
+    template<size_t... I>
+    static Local<Value> call_method(NativeMethod native_method,
+                                    gpointer this_object,
+                                    const Nan::FunctionCallbackInfo<Value> &info,
+                                    TrampolineIndices<I...>) {
+        return TrampolineReturn<ReturnKind>::call(native_method, this_object, ParamKinds::from_js(info[I])...);
+    }
+};
+
+} // namespace gir
@@ -1,7 +1,10 @@
 #include "function.h"
+#include "async_call.h"
 #include "exceptions.h"
 #include "namespace_loader.h"
 #include "object.h"
+#include "struct.h"
+#include "trampolines.h"
 #include "util.h"
 
 #include <nan.h>
@@ -13,9 +16,16 @@ using namespace v8;
 
 namespace gir {
 
-Local<Function> GIRFunction::prepare(GIFunctionInfo *function_info) {
-    // Create new function
-    Local<FunctionTemplate> js_function_template = GIRFunction::create_function(function_info);
+/**
+ * Creates the JS function for a namespace level function.
+ * If js_wrapper is true and the function has a trampoline then it's wrapped in
+ * a generated JS function that checks the arguments in JS (see Trampolines::create_js_wrapper).
+ */
+Local<Function> GIRFunction::prepare(GIFunctionInfo *function_info, bool js_wrapper) {
+    // Create new function. Like create_function, the plan lives as long as the function.
+    CallPlan *plan = new CallPlan(function_info);
+    Local<External> plan_extern = Nan::New<External>((void *)plan);
+    Local<FunctionTemplate> js_function_template = GIRFunction::create_function(*plan, plan_extern);
     Local<Function> js_function = js_function_template->GetFunction();
 
     // Set the function name
@@ -23,13 +33,37 @@ Local<Function> GIRFunction::prepare(GIFunctionInfo *function_info) {
     string js_name = Util::to_camel_case(string(native_name));
     js_function->SetName(Nan::New(js_name.c_str()).ToLocalChecked());
 
+    if (js_wrapper) {
+        Local<Function> js_wrapper_function = Trampolines::create_js_wrapper(*plan, plan_extern, js_function);
+        if (!js_wrapper_function.IsEmpty()) {
+            js_wrapper_function->SetName(Nan::New(js_name.c_str()).ToLocalChecked());
+            return js_wrapper_function;
+        }
+    }
     return js_function;
 }
 
+/**
+ * Creates a JS function template that will call the native function described
+ * by function_info. The function's CallPlan is built here, once, and attached
+ * to the template so that calls don't need to read the GI metadata again.
+ * If the function's signature only uses primitive types then the template
+ * calls it through a specialized trampoline rather than the generic path.
+ */
 Local<FunctionTemplate> GIRFunction::create_function(GIFunctionInfo *function_info) {
-    Local<External> function_info_extern = Nan::New<External>((void *)g_base_info_ref(function_info));
-    Local<FunctionTemplate> function_template = Nan::New<FunctionTemplate>(GIRFunction::InvokeFunction,
-                                                                           function_info_extern);
+    // the plan lives as long as the function template (i.e. the lifetime of the
+    // namespace) so we don't ever free it.
+    CallPlan *plan = new CallPlan(function_info);
+    return GIRFunction::create_function(*plan, Nan::New<External>((void *)plan));
+}
+
+Local<FunctionTemplate> GIRFunction::create_function(const CallPlan &plan, Local<External> plan_extern) {
+    Nan::FunctionCallback callback = plan.is_method ? nullptr : Trampolines::find(plan);
+    if (callback == nullptr) {
+        callback = GIRFunction::InvokeFunction;
+    }
+    Local<FunctionTemplate> function_template = Nan::New<FunctionTemplate>(callback, plan_extern);
+    GIRFunction::add_entry_points(function_template, plan_extern);
     return function_template;
 }
 
@@ -37,45 +71,400 @@ Local<FunctionTemplate> GIRFunction::create_function(GIFunctionInfo *function_in
 // that executes the native function specified by GIFunctionInfo with a given GObject
 // not just GIRObject's as is the case currently with GIRFunction::InvokeMethod!
 Local<FunctionTemplate> GIRFunction::create_method(GIFunctionInfo *function_info) {
-    Local<External> function_info_extern = Nan::New<External>((void *)g_base_info_ref(function_info));
-    Local<FunctionTemplate> function_template = Nan::New<FunctionTemplate>(GIRFunction::InvokeMethod,
-                                                                           function_info_extern);
+    CallPlan *plan = new CallPlan(function_info);
+    Local<External> plan_extern = Nan::New<External>((void *)plan);
+    Nan::FunctionCallback callback = Trampolines::find(*plan);
+    if (callback == nullptr) {
+        callback = GIRFunction::InvokeMethod;
+    }
+    Local<FunctionTemplate> function_template = Nan::New<FunctionTemplate>(callback, plan_extern);
+    GIRFunction::add_entry_points(function_template, plan_extern);
     return function_template;
 }
 
+/**
+ * Adds the alternative ways of calling a native function to it's JS function
+ * i.e. fn.view(...), fn.async(...), fn.callMany(...) and fn.parallel(...). They share the function's CallPlan.
+ * Methods called through an entry point take their instance as the first argument.
+ */
+void GIRFunction::add_entry_points(Local<FunctionTemplate> function_template, Local<External> plan_extern) {
+    function_template->Set(Nan::New("view").ToLocalChecked(),
+                           Nan::New<FunctionTemplate>(GIRFunction::InvokeView, plan_extern));
+    function_template->Set(Nan::New("async").ToLocalChecked(),
+                           Nan::New<FunctionTemplate>(GIRFunction::InvokeAsync, plan_extern));
+    function_template->Set(Nan::New("callMany").ToLocalChecked(),
+                           Nan::New<FunctionTemplate>(GIRFunction::InvokeMany, plan_extern));
+    function_template->Set(Nan::New("parallel").ToLocalChecked(),
+                           Nan::New<FunctionTemplate>(GIRFunction::InvokeParallel, plan_extern));
+}
+
 NAN_METHOD(GIRFunction::InvokeFunction) {
-    Local<External> function_info_extern = Local<External>::Cast(info.Data());
-    GIFunctionInfo *function_info = (GIFunctionInfo *)function_info_extern->Value();
-    Local<Value> js_func_result = GIRFunction::call(nullptr, function_info, info);
+    Local<External> plan_extern = Local<External>::Cast(info.Data());
+    CallPlan *plan = (CallPlan *)plan_extern->Value();
+    Local<Value> js_func_result = GIRFunction::call(nullptr, *plan, info);
     info.GetReturnValue().Set(js_func_result);
 }
 
 NAN_METHOD(GIRFunction::InvokeMethod) {
-    if (!info.This()->IsObject()) {
-        Nan::ThrowTypeError("the value of 'this' is not an object");
+    Local<External> plan_extern = Local<External>::Cast(info.Data());
+    CallPlan *plan = (CallPlan *)plan_extern->Value();
+    GObject *native_object = Trampolines::get_this_object(*plan, info);
+    if (native_object == nullptr) {
         return;
     }
 
-    GIRObject *that = Nan::ObjectWrap::Unwrap<GIRObject>(info.This()->ToObject());
-    GObject *native_object = that->get_gobject();
-    Local<External> function_info_extern = Local<External>::Cast(info.Data());
-    GIFunctionInfo *function_info = (GIFunctionInfo *)function_info_extern->Value();
-
-    Local<Value> js_func_result = GIRFunction::call(native_object, function_info, info);
+    Local<Value> js_func_result = GIRFunction::call(native_object, *plan, info);
     info.GetReturnValue().Set(js_func_result);
 }
 
-GIArgument GIRFunction::call_native(GIFunctionInfo *function_info, Args &args) {
-    GIArgument return_value;
+/**
+ * fn.view(...) calls the native function just like fn(...) except that arrays of
+ * numbers it returns are exposed to JS as TypedArrays over the native memory
+ * rather than copied. If the memory belongs to the instance of a method (i.e. a
+ * GObject or GBytes) then the instance is kept alive until the view is collected.
+ * e.g. `bytes.getData.view(bytes)`
+ */
+NAN_METHOD(GIRFunction::InvokeView) {
+    Local<External> plan_extern = Local<External>::Cast(info.Data());
+    CallPlan *plan = (CallPlan *)plan_extern->Value();
+    ArrayViewOwner view_owner = {nullptr, nullptr, nullptr};
+    if (!plan->is_method) {
+        info.GetReturnValue().Set(GIRFunction::call(nullptr, *plan, info, 0, &view_owner));
+        return;
+    }
+
+    if (info.Length() < 1 || !info[0]->IsObject()) {
+        Nan::ThrowTypeError("the first argument should be the instance to call the method on");
+        return;
+    }
+    gpointer instance = nullptr;
+    try {
+        instance = GIRFunction::get_instance(*plan, info[0], &view_owner);
+    } catch (exception &error) {
+        Nan::ThrowTypeError(error.what());
+        return;
+    }
+    info.GetReturnValue().Set(GIRFunction::call((GObject *)instance, *plan, info, 1, &view_owner));
+}
+
+/**
+ * fn.async(...) calls the native function on the libuv threadpool and returns a
+ * Promise for it's result (see AsyncCall). It's for blocking functions that are
+ * safe to call from another thread, i.e. `GLib.fileGetContents.async(path)`.
+ */
+NAN_METHOD(GIRFunction::InvokeAsync) {
+    Local<External> plan_extern = Local<External>::Cast(info.Data());
+    CallPlan *plan = (CallPlan *)plan_extern->Value();
+    if (!plan->is_method) {
+        info.GetReturnValue().Set(AsyncCall::start(nullptr, *plan, info, 0));
+        return;
+    }
+
+    if (info.Length() < 1 || !info[0]->IsObject()) {
+        Nan::ThrowTypeError("the first argument should be the instance to call the method on");
+        return;
+    }
+    ArrayViewOwner unused_view_owner = {nullptr, nullptr, nullptr};
+    gpointer instance = nullptr;
+    try {
+        instance = GIRFunction::get_instance(*plan, info[0], &unused_view_owner);
+    } catch (exception &error) {
+        Nan::ThrowTypeError(error.what());
+        return;
+    }
+    info.GetReturnValue().Set(AsyncCall::start((GObject *)instance, *plan, info, 1));
+}
+
+/**
+ * fn.callMany(batch) calls the native function once for every set of arguments
+ * in the batch, reusing one Args, and returns all of the results at once.
+ * The batch is either an array of argument arrays (rows) or, if any of it's
+ * elements is a TypedArray, an array of columns. Numbers in TypedArray columns
+ * that match their argument's native type are read without creating JS values.
+ * If the function returns a number (and has no OUT arguments) then the results
+ * are returned as a TypedArray, otherwise as an array.
+ * Methods take their instance as the first argument (or column).
+ * e.g. `GLib.unicharToupper.callMany([new Uint32Array(codepoints)])`
+ */
+NAN_METHOD(GIRFunction::InvokeMany) {
+    Local<External> plan_extern = Local<External>::Cast(info.Data());
+    CallPlan *plan = (CallPlan *)plan_extern->Value();
+    if (info.Length() < 1 || !info[0]->IsArray()) {
+        Nan::ThrowTypeError("callMany expects an array of argument arrays or an array of columns");
+        return;
+    }
+    try {
+        info.GetReturnValue().Set(GIRFunction::call_many(*plan, info[0].As<Array>()));
+    } catch (exception &error) {
+        Nan::ThrowError(error.what());
+    }
+}
+
+/**
+ * fn.parallel(batch, { threadSafe: true }) is like fn.callMany(batch) except that the
+ * calls are split across the libuv threadpool and it returns a Promise for the array
+ * of results (see ParallelCall). The batch is an array of argument arrays.
+ * The native function is called from several threads at once so the caller has to
+ * opt in by saying it's thread-safe, i.e. pure GLib functions like g_compute_checksum_for_string.
+ */
+NAN_METHOD(GIRFunction::InvokeParallel) {
+    Local<External> plan_extern = Local<External>::Cast(info.Data());
+    CallPlan *plan = (CallPlan *)plan_extern->Value();
+    if (info.Length() < 1 || !info[0]->IsArray()) {
+        Nan::ThrowTypeError("parallel expects an array of argument arrays");
+        return;
+    }
+    bool is_thread_safe = false;
+    if (info.Length() > 1 && info[1]->IsObject()) {
+        Local<Value> js_thread_safe = Nan::Get(info[1].As<Object>(), Nan::New("threadSafe").ToLocalChecked())
+                                          .ToLocalChecked();
+        is_thread_safe = js_thread_safe->IsTrue();
+    }
+    if (!is_thread_safe) {
+        Nan::ThrowTypeError("parallel calls the native function from several threads at once, "
+                            "pass { threadSafe: true } if it's safe to do so");
+        return;
+    }
+    info.GetReturnValue().Set(ParallelCall::start(*plan, info[0].As<Array>()));
+}
+
+// a column of a fn.callMany batch. If the column is a TypedArray that matches
+// it's argument's native type then 'data' points at it's elements.
+struct BatchColumn {
+    Local<Object> values;
+    guint8 *data;
+    size_t element_size;
+    int in_index; // the argument's slot in Args::in
+};
+
+static vector<BatchColumn> get_batch_columns(const CallPlan &plan, Local<Array> batch, uint32_t *n_calls) {
+    int this_offset = plan.is_method ? 1 : 0;
+    vector<BatchColumn> columns;
+    columns.reserve(batch->Length());
+    for (uint32_t i = 0; i < batch->Length(); i++) {
+        Local<Value> js_column = Nan::Get(batch, i).ToLocalChecked();
+        if (!js_column->IsArray() && !js_column->IsTypedArray()) {
+            throw JSArgumentTypeError("every column should be an array or a TypedArray");
+        }
+        BatchColumn column = {js_column.As<Object>(), nullptr, 0, -1};
+        uint32_t length = 0;
+        if (js_column->IsTypedArray()) {
+            Local<TypedArray> typed_array = js_column.As<TypedArray>();
+            length = typed_array->Length();
+            for (const ArgumentPlan &argument : plan.arguments) {
+                bool is_column_argument = argument.js_index >= 0 && argument.js_index + this_offset == (int)i;
+                if (is_column_argument && argument.direction == GI_DIRECTION_IN && length > 0 &&
+                    Args::typed_array_matches(typed_array, argument.type_tag)) {
+                    column.data = static_cast<guint8 *>(typed_array->Buffer()->GetContents().Data()) +
+                                  typed_array->ByteOffset();
+                    column.element_size = typed_array->ByteLength() / length;
+                    column.in_index = this_offset + argument.in_index;
+                }
+            }
+        } else {
+            length = js_column.As<Array>()->Length();
+        }
+
+        if (i == 0) {
+            *n_calls = length;
+        } else if (length != *n_calls) {
+            throw JSValueError("every column should have the same length");
+        }
+        columns.push_back(column);
+    }
+    return columns;
+}
+
+// returns true if the native function's results can be written
+// straight into a TypedArray (see GIRFunction::call_many)
+static bool has_numeric_results(const CallPlan &plan) {
+    if (plan.skip_return || plan.n_out_results > 0) {
+        return false;
+    }
+    switch (plan.return_tag) {
+        case GI_TYPE_TAG_INT8:
+        case GI_TYPE_TAG_UINT8:
+        case GI_TYPE_TAG_INT16:
+        case GI_TYPE_TAG_UINT16:
+        case GI_TYPE_TAG_INT32:
+        case GI_TYPE_TAG_UINT32:
+        case GI_TYPE_TAG_UNICHAR:
+        case GI_TYPE_TAG_FLOAT:
+        case GI_TYPE_TAG_DOUBLE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+Local<Value> GIRFunction::call_many(const CallPlan &plan, Local<Array> batch) {
+    int this_offset = plan.is_method ? 1 : 0;
+    bool is_columns = false;
+    for (uint32_t i = 0; i < batch->Length() && !is_columns; i++) {
+        is_columns = Nan::Get(batch, i).ToLocalChecked()->IsTypedArray();
+    }
+    uint32_t n_calls = batch->Length();
+    vector<BatchColumn> columns;
+    if (is_columns) {
+        columns = get_batch_columns(plan, batch, &n_calls);
+    }
+
+    // the results are allocated up front. Numbers are written straight
+    // into the TypedArray's memory.
+    Local<Value> results;
+    guint8 *result_data = nullptr;
+    size_t result_size = 0;
+    bool numeric_results = has_numeric_results(plan);
+    if (numeric_results) {
+        Local<TypedArray> typed_results = Args::from_g_type_numeric_array(nullptr, n_calls, plan.return_tag)
+                                              .As<TypedArray>();
+        result_data = static_cast<guint8 *>(typed_results->Buffer()->GetContents().Data());
+        result_size = n_calls > 0 ? typed_results->ByteLength() / n_calls : 0;
+        results = typed_results;
+    } else if (plan.skip_return && plan.n_out_results == 0) {
+        results = Nan::Undefined();
+    } else {
+        results = Nan::New<Array>(n_calls);
+    }
+
+    Args args(plan);
+    ArrayViewOwner unused_view_owner = {nullptr, nullptr, nullptr};
+    vector<Local<Value>> js_values(columns.size());
+    for (uint32_t i = 0; i < n_calls; i++) {
+        Nan::HandleScope scope;
+        if (is_columns) {
+            for (size_t j = 0; j < columns.size(); j++) {
+                // values we copy straight from a TypedArray are left empty (see Args::load_js_arguments)
+                js_values[j] = columns[j].data != nullptr ? Local<Value>()
+                                                          : Nan::Get(columns[j].values, i).ToLocalChecked();
+            }
+        } else {
+            Local<Value> js_row = Nan::Get(batch, i).ToLocalChecked();
+            if (!js_row->IsArray()) {
+                throw JSArgumentTypeError("every element of the batch should be an array of arguments");
+            }
+            Local<Array> row = js_row.As<Array>();
+            js_values.resize(row->Length());
+            for (uint32_t j = 0; j < row->Length(); j++) {
+                js_values[j] = Nan::Get(row, j).ToLocalChecked();
+            }
+        }
+
+        GObject *instance = nullptr;
+        if (plan.is_method) {
+            if (js_values.empty() || js_values[0].IsEmpty() || !js_values[0]->IsObject()) {
+                throw JSArgumentTypeError("the first argument of every call should be the instance of the method");
+            }
+            instance = (GObject *)GIRFunction::get_instance(plan, js_values[0], &unused_view_owner);
+            if (instance == nullptr) {
+                throw JSArgumentTypeError("method calls require a native object as the value of 'this'");
+            }
+        }
+
+        args.load_js_arguments(js_values.data() + this_offset, (int)js_values.size() - this_offset);
+        for (const BatchColumn &column : columns) {
+            if (column.data != nullptr) {
+                memcpy(&args.in[column.in_index], column.data + i * column.element_size, column.element_size);
+            }
+        }
+        if (plan.is_method) {
+            args.load_context(instance);
+        }
+
+        GIArgument result = GIRFunction::call_native(plan, args);
+        if (numeric_results) {
+            // every member of a GIArgument starts at it's first byte
+            memcpy(result_data + i * result_size, &result, result_size);
+        } else if (results->IsArray()) {
+            Nan::Set(results.As<Array>(),
+                     i,
+                     GIRFunction::js_return_value_from_native_call(plan, args, result, nullptr));
+        }
+        args.reset();
+    }
+    return results;
+}
+
+/**
+ * Unwraps the native instance for a method from it's JS wrapper and
+ * works out if it's something we can keep alive (see ArrayViewOwner).
+ * Throws a JSArgumentTypeError if the JS value doesn't wrap an instance of
+ * the method's class, interface or struct.
+ */
+gpointer GIRFunction::get_instance(const CallPlan &plan, Local<Value> js_instance, ArrayViewOwner *view_owner) {
+    GIBaseInfo *container_info = g_base_info_get_container(plan.callable_info.get());
+    GIInfoType container_type = g_base_info_get_type(container_info);
+    if (container_type == GI_INFO_TYPE_OBJECT || container_type == GI_INFO_TYPE_INTERFACE) {
+        GIRObject *gir_object = GIRObject::unwrap(js_instance, g_registered_type_info_get_g_type(container_info));
+        if (gir_object == nullptr) {
+            throw JSArgumentTypeError(string("the instance should be a ") + g_base_info_get_name(container_info));
+        }
+        GObject *instance = gir_object->get_gobject();
+        *view_owner = {instance, g_object_ref, g_object_unref};
+        return instance;
+    }
+
+    GIRStruct *gir_struct = GIRStruct::unwrap(js_instance, container_info);
+    if (gir_struct == nullptr) {
+        throw JSArgumentTypeError(string("the instance should be a ") + g_base_info_get_name(container_info));
+    }
+    gpointer instance = gir_struct->get_native_ptr();
+    if (instance != nullptr && g_registered_type_info_get_g_type(container_info) == G_TYPE_BYTES) {
+        *view_owner = {instance, (gpointer(*)(gpointer))g_bytes_ref, (GDestroyNotify)g_bytes_unref};
+    }
+    return instance;
+}
+
+/**
+ * Calls the native function through the CallPlan's prepared invoker.
+ * libffi wants a pointer to the value of every argument (in the order the
+ * native function declares them). IN arguments point straight at their
+ * GIArgument. OUT and INOUT arguments are passed to the native function as
+ * pointers so we point at a pointer to the GIArgument the native function
+ * will write into (or, for caller-allocates arguments, at the memory we
+ * allocated for it).
+ */
+GIArgument GIRFunction::call_native(const CallPlan &plan, Args &args) {
+    if (!plan.invoker_ready) {
+        throw NativeGError(plan.invoker_error);
+    }
+
     GError *error = nullptr;
+    GError **error_pointer = &error;
+    int this_offset = plan.is_method ? 1 : 0;
 
-    g_function_info_invoke(function_info,
-                           args.in.data(),
-                           args.in.size(),
-                           args.out.data(),
-                           args.out.size(),
-                           &return_value,
-                           &error);
+    InlineVector<gpointer, ARGS_INLINE_CAPACITY> out_pointers;
+    InlineVector<gpointer, ARGS_INLINE_CAPACITY + 2> ffi_arguments; // +2 for 'this' and the GError
+    out_pointers.resize(plan.n_out);
+    ffi_arguments.reserve(plan.arguments.size() + this_offset + (plan.can_throw ? 1 : 0));
+
+    if (plan.is_method) {
+        ffi_arguments.push_back(&args.in[0]);
+    }
+    for (const ArgumentPlan &argument : plan.arguments) {
+        if (argument.direction == GI_DIRECTION_IN) {
+            ffi_arguments.push_back(&args.in[this_offset + argument.in_index]);
+        } else {
+            GIArgument &out_argument = args.out[argument.out_index];
+            if (argument.caller_allocates) {
+                out_pointers[argument.out_index] = out_argument.v_pointer;
+            } else {
+                out_pointers[argument.out_index] = &out_argument;
+            }
+            ffi_arguments.push_back(&out_pointers[argument.out_index]);
+        }
+    }
+    if (plan.can_throw) {
+        ffi_arguments.push_back(&error_pointer);
+    }
+
+    GIFFIReturnValue ffi_return_value;
+    ffi_call(&plan.invoker.cif, FFI_FN(plan.invoker.native_address), &ffi_return_value, ffi_arguments.data());
+
+    // libffi widens small integer return values so we need GI to pull the
+    // correctly sized value out for us.
+    GIArgument return_value;
+    gi_type_info_extract_ffi_return_value(&plan.return_type_info, &ffi_return_value, &return_value);
 
     if (error != nullptr) {
         string message = string(error->message);
@@ -88,16 +477,24 @@ GIArgument GIRFunction::call_native(GIFunctionInfo *function_info, Args &args) {
     return return_value;
 }
 
+/**
+ * Calls the native function with the JS function call's arguments.
+ * @param js_offset is the position of the first JS argument that maps to a native argument
+ * @param view_owner if it's not nullptr then returned arrays are views over
+ *        the native memory where possible (see GIRFunction::InvokeView)
+ */
 Local<Value> GIRFunction::call(GObject *obj,
-                               GIFunctionInfo *function_info,
-                               const Nan::FunctionCallbackInfo<v8::Value> &js_callback_info) {
+                               const CallPlan &plan,
+                               const Nan::FunctionCallbackInfo<v8::Value> &js_callback_info,
+                               int js_offset,
+                               const ArrayViewOwner *view_owner) {
     // we want to catch any errors we may encounter so we can throw them as JS
     // errors
     try {
         // create the arguments for the native function
-        Args args = Args(function_info);
-        args.load_js_arguments(js_callback_info);
-        if (g_callable_info_is_method(function_info)) {
+        Args args(plan);
+        args.load_js_arguments(js_callback_info, js_offset);
+        if (plan.is_method) {
             if (obj != nullptr) {
                 args.load_context(obj);
             } else {
@@ -107,12 +504,12 @@ Local<Value> GIRFunction::call(GObject *obj,
 
         // call the native function. CallNative is just a small wrapper to help with
         // handling native errors and return values.
-        GIArgument result = GIRFunction::call_native(function_info, args);
+        GIArgument result = GIRFunction::call_native(plan, args);
 
         // handle the return value that we should pass back to JS.
         // there are some rules to decide how to handle there output from the native
         // function so we'll use a helper function to handle that logic for us.
-        Local<Value> js_return_value = GIRFunction::js_return_value_from_native_call(function_info, args, result);
+        Local<Value> js_return_value = GIRFunction::js_return_value_from_native_call(plan, args, result, view_owner);
         return js_return_value;
     } catch (exception &error) {
         // if any exception happens we want to translate it to a JS error and return
@@ -134,54 +531,52 @@ Local<Value> GIRFunction::call(GObject *obj,
  * - If the native function has a return value and 1 or more out-args then return them as an array with the return value
  * in position 0: [return-value, out-arg-1, out-arg-2, ..., out-arg-n]
  */
-Local<Value> GIRFunction::js_return_value_from_native_call(GIFunctionInfo *function_info,
+Local<Value> GIRFunction::js_return_value_from_native_call(const CallPlan &plan,
                                                            Args &args,
-                                                           GIArgument &native_call_result) {
-    // load the function's return type info
-    GITypeInfo return_type_info;
-    g_callable_info_load_return_type(function_info, &return_type_info);
-
+                                                           GIArgument &native_call_result,
+                                                           const ArrayViewOwner *view_owner) {
     // if the function's metadata says to skip the return value (meaning the
     // return value is only useful in C) or the return value is void, then we can
     // skip the return value when determining what should be returned from native
-    // to JS.
-    bool skip_return_value = g_callable_info_skip_return(function_info) ||
-                             g_type_info_get_tag(&return_type_info) == GI_TYPE_TAG_VOID;
-    int number_of_return_values = skip_return_value ? args.out.size() : args.out.size() + 1;
+    // to JS. The CallPlan has already worked this out for us.
+    int number_of_return_values = plan.skip_return ? plan.n_out_results : plan.n_out_results + 1;
 
     Local<Array> js_result_array = Nan::New<Array>(number_of_return_values);
 
     // if we should NOT skip the native return value, then we should convert it to
     // JS and set it in position 0 of the returned value array
-    if (!skip_return_value) {
-        Local<Value> js_return_value = Args::from_g_type(&native_call_result, &return_type_info, 0);
+    if (!plan.skip_return) {
+        Local<Value> js_return_value = Args::from_g_type(&native_call_result,
+                                                         &plan.return_type_info,
+                                                         plan.return_tag,
+                                                         plan.return_interface_info.get(),
+                                                         args.get_array_length(plan.return_array_length_index),
+                                                         plan.return_transfer,
+                                                         view_owner);
         js_result_array->Set(0, js_return_value);
     }
 
-    // We need to handle OUT arguments from the native call.
-    // If we had some out args then
-    // foreach native argument, if it's an our arg, grab the next out arg from
-    // args and add it to the next position in the js_result_array. The code here
-    // is a bit confusing because `g_callable_info_load_arg(info, index)` requires
-    // the argument index where the index is relative to ALL arguments where as
-    // args.out.data() is an array of just the OUT args (doesn't include IN args)
-    // so we can't just loop over args.out :(
-    int js_results_array_pos = skip_return_value ? 0 : 1; // if there is a return_value then we need to
-                                                          // offset the out args by 1 i.e.
-                                                          // [return_value, out-arg-1, out-arg-2, ...]
-    int next_out_arg_pos = 0;
-    if (args.out.size() > 0) {
-        for (int i = 0; i < g_callable_info_get_n_args(function_info); i++) {
-            GIArgInfo argument_info;
-            g_callable_info_load_arg(function_info, i, &argument_info);
-            GIDirection argument_direction = g_arg_info_get_direction(&argument_info);
-            if (argument_direction == GI_DIRECTION_OUT) {
-                GITypeInfo out_arg_type_info;
-                g_arg_info_load_type(&argument_info, &out_arg_type_info);
-                js_result_array->Set(js_results_array_pos,
-                                     Args::from_g_type(&args.out[next_out_arg_pos], &out_arg_type_info, 0));
-                next_out_arg_pos += 1;
-                js_results_array_pos += 1;
+    // We need to handle OUT (and INOUT) arguments from the native call.
+    // The CallPlan knows each argument's position in args.out and in the
+    // js_result_array. OUT arguments that are just the length of an array
+    // aren't passed back to JS (the JS array has it's own length).
+    // If there is a return_value then we need to offset the out args by 1
+    // i.e. [return_value, out-arg-1, out-arg-2, ...]
+    int js_results_array_offset = plan.skip_return ? 0 : 1;
+    if (plan.n_out_results > 0) {
+        for (const ArgumentPlan &argument : plan.arguments) {
+            if (argument.result_index >= 0) {
+                // caller-allocated memory belongs to the call's arena, so
+                // it has to be copied no matter what the transfer says.
+                GITransfer transfer = argument.caller_allocates ? GI_TRANSFER_NOTHING : argument.transfer;
+                js_result_array->Set(js_results_array_offset + argument.result_index,
+                                     Args::from_g_type(&args.out[argument.out_index],
+                                                       &argument.type_info,
+                                                       argument.type_tag,
+                                                       argument.interface_info.get(),
+                                                       args.get_array_length(argument.array_length_index),
+                                                       transfer,
+                                                       view_owner));
             }
         }
     }
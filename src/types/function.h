@@ -5,33 +5,50 @@
 #include <nan.h>
 #include <v8.h>
 #include <map>
+#include <vector>
 #include "arguments.h"
+#include "call_plan.h"
 
 namespace gir {
 
 using namespace v8;
 
 class GIRFunction : public Nan::ObjectWrap {
+    friend class AsyncCall;
+    friend class AsyncReadyCall;
+    friend class ParallelCall;
+
 public:
-    static Local<Function> prepare(GIFunctionInfo *info);
+    static Local<Function> prepare(GIFunctionInfo *info, bool js_wrapper = false);
     static Local<FunctionTemplate> create_function(GIFunctionInfo *function_info);
     static Local<FunctionTemplate> create_method(GIFunctionInfo *function_info);
+    static void add_entry_points(Local<FunctionTemplate> function_template, Local<External> plan_extern);
 
 public:
     // call_native and call should be private
     // we are just waiting for GIRStruct to be rewritten
-    static GIArgument call_native(GIFunctionInfo *function_info, Args &function_arguments);
+    static GIArgument call_native(const CallPlan &plan, Args &function_arguments);
     static v8::Local<v8::Value> call(GObject *obj,
-                                     GIFunctionInfo *function_info,
-                                     const Nan::FunctionCallbackInfo<v8::Value> &args);
+                                     const CallPlan &plan,
+                                     const Nan::FunctionCallbackInfo<v8::Value> &args,
+                                     int js_offset = 0,
+                                     const ArrayViewOwner *view_owner = nullptr);
 
 private:
     GIRFunction() = default;
-    static Local<Value> js_return_value_from_native_call(GIFunctionInfo *function_info,
+    static Local<Value> js_return_value_from_native_call(const CallPlan &plan,
                                                          Args &args,
-                                                         GIArgument &native_call_result);
+                                                         GIArgument &native_call_result,
+                                                         const ArrayViewOwner *view_owner);
+    static Local<FunctionTemplate> create_function(const CallPlan &plan, Local<External> plan_extern);
+    static gpointer get_instance(const CallPlan &plan, Local<Value> js_instance, ArrayViewOwner *view_owner);
+    static Local<Value> call_many(const CallPlan &plan, Local<Array> batch);
     static NAN_METHOD(InvokeFunction);
     static NAN_METHOD(InvokeMethod);
+    static NAN_METHOD(InvokeView);
+    static NAN_METHOD(InvokeAsync);
+    static NAN_METHOD(InvokeMany);
+    static NAN_METHOD(InvokeParallel);
 };
 
 } // namespace gir
@@ -0,0 +1,273 @@
+#include <exception>
+
+#include "arguments.h"
+#include "types/list.h"
+
+namespace gir {
+
+Nan::Persistent<FunctionTemplate> GIRList::instance_template;
+Nan::Persistent<Function> GIRList::instance_constructor;
+
+static gpointer *node_data(gpointer node, bool is_slist) {
+    return is_slist ? &((GSList *)node)->data : &((GList *)node)->data;
+}
+
+static gpointer next_node(gpointer node, bool is_slist) {
+    return is_slist ? (gpointer)((GSList *)node)->next : (gpointer)((GList *)node)->next;
+}
+
+Local<Function> GIRList::get_js_constructor() {
+    if (GIRList::instance_constructor.IsEmpty()) {
+        Local<FunctionTemplate> object_template = Nan::New<FunctionTemplate>();
+        object_template->SetClassName(Nan::New("GList").ToLocalChecked());
+        object_template->InstanceTemplate()->SetInternalFieldCount(1);
+        Nan::SetPrototypeMethod(object_template, "next", GIRList::next);
+        Nan::SetPrototypeMethod(object_template, "toArray", GIRList::to_array);
+        object_template->PrototypeTemplate()->Set(Symbol::GetIterator(Isolate::GetCurrent()),
+                                                  Nan::New<FunctionTemplate>(GIRList::iterator));
+        GIRList::instance_template.Reset(object_template);
+        GIRList::instance_constructor.Reset(Nan::GetFunction(object_template).ToLocalChecked());
+    }
+    return Nan::New(GIRList::instance_constructor);
+}
+
+// returns the list a JS value wraps or nullptr (with a TypeError thrown) if it isn't one.
+GIRList *GIRList::unwrap(Local<Value> value) {
+    if (GIRList::instance_template.IsEmpty() || !Nan::New(GIRList::instance_template)->HasInstance(value)) {
+        Nan::ThrowTypeError("the value of 'this' should be a GList");
+        return nullptr;
+    }
+    return Nan::ObjectWrap::Unwrap<GIRList>(value.As<Object>());
+}
+
+/**
+ * Wraps a native GList or GSList.
+ * If the list is borrowed (transfer none) then we copy it straight away because
+ * the native side is free to change it while we're lazily walking it. If only the
+ * container is ours (transfer container) we keep it. In both cases elements we
+ * know how to copy (or ref) are copied, so they stay valid until they're read.
+ */
+Local<Value> GIRList::from_existing(gpointer list, GITypeInfo *list_type_info, GITransfer transfer) {
+    GIRList *gir_list = new GIRList();
+    gir_list->is_slist = g_type_info_get_tag(list_type_info) == GI_TYPE_TAG_GSLIST;
+    gir_list->element_type_info = GIRInfoUniquePtr(g_type_info_get_param_type(list_type_info, 0));
+    GITypeInfo *element_type_info = gir_list->element_type_info.get();
+    GITypeTag element_tag = g_type_info_get_tag(element_type_info);
+    if (element_tag == GI_TYPE_TAG_INTERFACE) {
+        gir_list->element_interface_info = GIRInfoUniquePtr(g_type_info_get_interface(element_type_info));
+    }
+    gir_list->element_kind = GIRList::get_element_kind(element_tag,
+                                                       gir_list->element_interface_info.get(),
+                                                       &gir_list->element_g_type);
+
+    bool copy_elements = gir_list->element_kind != ListElementKind::VALUE &&
+                         gir_list->element_kind != ListElementKind::OTHER;
+    if (transfer == GI_TRANSFER_NOTHING) {
+        if (copy_elements) {
+            GCopyFunc copy = [](gconstpointer data, gpointer self) -> gpointer {
+                return static_cast<GIRList *>(self)->copy_element(const_cast<gpointer>(data));
+            };
+            gir_list->head = gir_list->is_slist ? (gpointer)g_slist_copy_deep((GSList *)list, copy, gir_list)
+                                                : (gpointer)g_list_copy_deep((GList *)list, copy, gir_list);
+        } else {
+            gir_list->head = gir_list->is_slist ? (gpointer)g_slist_copy((GSList *)list)
+                                                : (gpointer)g_list_copy((GList *)list);
+        }
+        gir_list->owns_elements = copy_elements;
+    } else if (transfer == GI_TRANSFER_CONTAINER) {
+        gir_list->head = list;
+        if (copy_elements) {
+            for (gpointer node = list; node != nullptr; node = next_node(node, gir_list->is_slist)) {
+                gpointer *data = node_data(node, gir_list->is_slist);
+                *data = gir_list->copy_element(*data);
+            }
+        }
+        gir_list->owns_elements = copy_elements;
+    } else {
+        gir_list->head = list;
+        gir_list->owns_elements = true;
+    }
+    gir_list->current = gir_list->head;
+
+    Local<Object> instance = Nan::NewInstance(GIRList::get_js_constructor()).ToLocalChecked();
+    gir_list->Wrap(instance);
+    return instance;
+}
+
+ListElementKind GIRList::get_element_kind(GITypeTag element_tag, GIBaseInfo *interface_info, GType *g_type) {
+    switch (element_tag) {
+        case GI_TYPE_TAG_BOOLEAN:
+        case GI_TYPE_TAG_INT8:
+        case GI_TYPE_TAG_UINT8:
+        case GI_TYPE_TAG_INT16:
+        case GI_TYPE_TAG_UINT16:
+        case GI_TYPE_TAG_INT32:
+        case GI_TYPE_TAG_UINT32:
+        case GI_TYPE_TAG_UNICHAR:
+            return ListElementKind::VALUE;
+
+        case GI_TYPE_TAG_UTF8:
+        case GI_TYPE_TAG_FILENAME:
+            return ListElementKind::STRING;
+
+        case GI_TYPE_TAG_INTERFACE:
+            switch (g_base_info_get_type(interface_info)) {
+                case GI_INFO_TYPE_ENUM:
+                case GI_INFO_TYPE_FLAGS:
+                    return ListElementKind::VALUE;
+                case GI_INFO_TYPE_OBJECT:
+                case GI_INFO_TYPE_INTERFACE:
+                    return ListElementKind::OBJECT;
+                case GI_INFO_TYPE_STRUCT:
+                case GI_INFO_TYPE_BOXED:
+                case GI_INFO_TYPE_UNION:
+                    *g_type = g_registered_type_info_get_g_type(interface_info);
+                    if (G_TYPE_IS_BOXED(*g_type)) {
+                        return ListElementKind::BOXED;
+                    }
+                    return ListElementKind::OTHER;
+                default:
+                    return ListElementKind::OTHER;
+            }
+
+        default:
+            return ListElementKind::OTHER;
+    }
+}
+
+gpointer GIRList::copy_element(gpointer data) {
+    if (data == nullptr) {
+        return nullptr;
+    }
+    switch (this->element_kind) {
+        case ListElementKind::STRING:
+            return g_strdup(static_cast<const char *>(data));
+        case ListElementKind::OBJECT:
+            return g_object_ref(data);
+        case ListElementKind::BOXED:
+            return g_boxed_copy(this->element_g_type, data);
+        default:
+            return data;
+    }
+}
+
+void GIRList::free_element(gpointer data) {
+    if (data == nullptr) {
+        return;
+    }
+    switch (this->element_kind) {
+        case ListElementKind::STRING:
+            g_free(data);
+            break;
+        case ListElementKind::OBJECT:
+            g_object_unref(data);
+            break;
+        case ListElementKind::BOXED:
+            g_boxed_free(this->element_g_type, data);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * converts the current element to a JS value and moves on to the next one.
+ * if we own the element then ownership is passed to the JS value.
+ */
+Local<Value> GIRList::take_current() {
+    gpointer *data = node_data(this->current, this->is_slist);
+    GITypeTag element_tag = g_type_info_get_tag(this->element_type_info.get());
+    GIArgument element = Args::pointer_to_g_argument(*data, element_tag, this->element_interface_info.get());
+    GITransfer element_transfer = this->owns_elements ? GI_TRANSFER_EVERYTHING : GI_TRANSFER_NOTHING;
+
+    Local<Value> js_value = Args::from_g_type(&element,
+                                              this->element_type_info.get(),
+                                              element_tag,
+                                              this->element_interface_info.get(),
+                                              -1,
+                                              element_transfer);
+    if (this->owns_elements) {
+        // the JS value owns it now, make sure we don't free it with the list
+        *data = nullptr;
+    }
+    this->current = next_node(this->current, this->is_slist);
+    return js_value;
+}
+
+/**
+ * frees the list container and any elements we still own.
+ */
+void GIRList::free_list() {
+    if (this->owns_elements) {
+        for (gpointer node = this->head; node != nullptr; node = next_node(node, this->is_slist)) {
+            this->free_element(*node_data(node, this->is_slist));
+        }
+    }
+    if (this->is_slist) {
+        g_slist_free((GSList *)this->head);
+    } else {
+        g_list_free((GList *)this->head);
+    }
+    this->head = nullptr;
+    this->current = nullptr;
+}
+
+GIRList::~GIRList() {
+    this->free_list();
+}
+
+/**
+ * implements the JS iterator protocol, the list is freed
+ * as soon as it's last element has been read.
+ */
+NAN_METHOD(GIRList::next) {
+    GIRList *list = GIRList::unwrap(info.This());
+    if (list == nullptr) {
+        return;
+    }
+    Local<Object> result = Nan::New<Object>();
+    try {
+        if (list->current == nullptr) {
+            Nan::Set(result, Nan::New("value").ToLocalChecked(), Nan::Undefined());
+            Nan::Set(result, Nan::New("done").ToLocalChecked(), Nan::True());
+        } else {
+            Nan::Set(result, Nan::New("value").ToLocalChecked(), list->take_current());
+            Nan::Set(result, Nan::New("done").ToLocalChecked(), Nan::False());
+        }
+    } catch (std::exception &error) {
+        Nan::ThrowError(error.what());
+        return;
+    }
+    if (list->current == nullptr) {
+        list->free_list();
+    }
+    info.GetReturnValue().Set(result);
+}
+
+NAN_METHOD(GIRList::iterator) {
+    info.GetReturnValue().Set(info.This());
+}
+
+/**
+ * reads the rest of the list into a JS array in one go.
+ */
+NAN_METHOD(GIRList::to_array) {
+    GIRList *list = GIRList::unwrap(info.This());
+    if (list == nullptr) {
+        return;
+    }
+    guint length = list->is_slist ? g_slist_length((GSList *)list->current) : g_list_length((GList *)list->current);
+    Local<Array> array = Nan::New<Array>(length);
+    try {
+        for (guint i = 0; i < length; i++) {
+            Nan::Set(array, i, list->take_current());
+        }
+    } catch (std::exception &error) {
+        Nan::ThrowError(error.what());
+        return;
+    }
+    list->free_list();
+    info.GetReturnValue().Set(array);
+}
+
+} // namespace gir
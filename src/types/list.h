@@ -0,0 +1,67 @@
+#pragma once
+
+#include <girepository.h>
+#include <glib.h>
+#include <nan.h>
+#include <v8.h>
+#include "util.h"
+
+namespace gir {
+
+using namespace v8;
+
+// how we manage the elements of a list we've wrapped,
+// so we know how to take ownership of them and free them.
+enum class ListElementKind {
+    VALUE,  // integers stored in the pointer itself, nothing to manage
+    STRING, // copied with g_strdup and freed with g_free
+    OBJECT, // a GObject, ref'd and unref'd
+    BOXED,  // a boxed type, copied with g_boxed_copy and freed with g_boxed_free
+    OTHER,  // we don't know how to copy or free these so they're always borrowed
+};
+
+/**
+ * This class wraps a native GList or GSList and exposes it to JS as an iterator.
+ * Elements are only converted to JS values as they're read, so finding the first
+ * match in a long list doesn't convert (or wrap) the rest of it.
+ * The list is freed (according to it's transfer mode) as soon as it's exhausted,
+ * or when the JS object is garbage collected.
+ * @example
+ * for (const child of container.getChildren()) { ... }
+ * const children = container.getChildren().toArray();
+ */
+class GIRList : public Nan::ObjectWrap {
+public:
+    static Local<Value> from_existing(gpointer list, GITypeInfo *list_type_info, GITransfer transfer);
+
+private:
+    static Nan::Persistent<FunctionTemplate> instance_template;
+    static Nan::Persistent<Function> instance_constructor;
+
+    gpointer head = nullptr;    // the list we own, we free the container when we're done with it
+    gpointer current = nullptr; // the next element to return to JS
+    bool is_slist = false;
+    bool owns_elements = false; // true if the elements we haven't returned yet must be freed
+    ListElementKind element_kind = ListElementKind::OTHER;
+    GType element_g_type = G_TYPE_NONE;
+    GIRInfoUniquePtr element_type_info = nullptr;
+    GIRInfoUniquePtr element_interface_info = nullptr;
+
+    static Local<Function> get_js_constructor();
+    static GIRList *unwrap(Local<Value> value);
+    static ListElementKind get_element_kind(GITypeTag element_tag, GIBaseInfo *interface_info, GType *g_type);
+
+    gpointer copy_element(gpointer data);
+    void free_element(gpointer data);
+    Local<Value> take_current();
+    void free_list();
+
+    static NAN_METHOD(next);
+    static NAN_METHOD(iterator);
+    static NAN_METHOD(to_array);
+
+    GIRList() = default;
+    ~GIRList();
+};
+
+} // namespace gir
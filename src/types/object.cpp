@@ -1,7 +1,9 @@
 #include <iostream>
 #include <string>
 
+#include "async_call.h"
 #include "closure.h"
+#include "exceptions.h"
 #include "namespace_loader.h"
 #include "object.h"
 #include "types/function.h"
@@ -9,6 +11,7 @@
 #include "values.h"
 
 #include <node.h>
+#include <algorithm>
 #include <cstring>
 
 using namespace v8;
@@ -17,8 +20,15 @@ using namespace std;
 namespace gir {
 
 // initialize static properties
-std::vector<ObjectFunctionTemplate *> GIRObject::templates;
-std::set<GIRObject *> GIRObject::instances;
+std::unordered_map<GType, ObjectFunctionTemplate> GIRObject::templates;
+std::unordered_map<GType, ObjectFunctionTemplate *> GIRObject::ancestor_templates;
+std::unordered_map<GType, PropertyTable> GIRObject::property_tables;
+GThread *GIRObject::js_thread = nullptr;
+uv_async_t *GIRObject::pending_toggles_async = nullptr;
+std::mutex GIRObject::pending_toggles_mutex;
+std::unordered_set<GObject *> GIRObject::pending_toggles;
+std::unordered_set<GObject *> GIRObject::pending_releases;
+std::unordered_map<GObject *, GIRObject *> GIRObject::instances;
 
 GIRObject::GIRObject(GIObjectInfo *object_info, map<string, GValue> &properties) {
     this->info = object_info;
@@ -48,6 +58,110 @@ GIRObject::GIRObject(GIObjectInfo *object_info, map<string, GValue> &properties)
         }
         this->obj = G_OBJECT(g_object_newv(object_type, parameters.size(), parameters.data()));
 #endif
+        // GInitiallyUnowned objects (i.e. widgets) start with a floating
+        // reference, we want to own it.
+        if (g_object_is_floating(this->obj)) {
+            g_object_ref_sink(this->obj);
+        }
+    }
+}
+
+/**
+ * wrappers are freed by V8's weak callback, in the middle of GC. Dropping the toggle
+ * reference there would finalize the GObject, running it's dispose handlers (signal
+ * handlers, toggle notifications of it's children...) which can't use V8 during GC.
+ * So the reference is dropped later by process_pending_toggles.
+ */
+GIRObject::~GIRObject() {
+    if (this->obj != nullptr) {
+        auto instance = GIRObject::instances.find(this->obj);
+        if (instance != GIRObject::instances.end() && instance->second == this) {
+            GIRObject::instances.erase(instance);
+        }
+        GIRObject::pending_releases.insert(this->obj);
+        uv_async_send(GIRObject::pending_toggles_async);
+    }
+}
+
+/**
+ * Swaps the strong reference the wrapper holds on it's GObject for a toggle reference.
+ * While native code holds other references to the GObject the JS wrapper is kept alive
+ * (it can be handed back to JS again, with any JS properties that were set on it).
+ * When the wrapper's reference is the only one left the wrapper becomes weak so V8 can
+ * collect it, which drops the last reference and finalizes the GObject.
+ * Must be called after the wrapper has been wrapped (see Nan::ObjectWrap::Wrap)
+ * and added to instances, the toggle notifications find the wrapper there.
+ */
+void GIRObject::add_toggle_ref() {
+    if (GIRObject::js_thread == nullptr) {
+        GIRObject::js_thread = g_thread_self();
+        GIRObject::pending_toggles_async = new uv_async_t();
+        uv_async_init(Nan::GetCurrentEventLoop(), GIRObject::pending_toggles_async, GIRObject::process_pending_toggles);
+        // the handle shouldn't keep node running
+        uv_unref((uv_handle_t *)GIRObject::pending_toggles_async);
+    }
+    // if a previous wrapper's toggle reference hasn't been dropped yet we take it over
+    if (GIRObject::pending_releases.erase(this->obj) == 0) {
+        g_object_add_toggle_ref(this->obj, GIRObject::toggle_notify, nullptr);
+    }
+    g_object_unref(this->obj);
+    this->set_strong(g_atomic_int_get(&this->obj->ref_count) > 1);
+}
+
+void GIRObject::set_strong(bool strong) {
+    if (strong && !this->is_strong) {
+        this->Ref();
+    } else if (!strong && this->is_strong) {
+        this->Unref();
+    }
+    this->is_strong = strong;
+}
+
+/**
+ * called by GObject when the toggle reference becomes (or stops being) the last
+ * reference. It can be called from any thread (i.e. when a GTask's worker drops a
+ * reference) but V8 can only be used on the JS thread so those are queued.
+ * The wrapper is looked up by it's GObject as it may already have been collected.
+ */
+void GIRObject::toggle_notify(gpointer data, GObject *object, gboolean is_last_ref) {
+    if (g_thread_self() == GIRObject::js_thread) {
+        GIRObject::set_strong_from_ref_count(object);
+        return;
+    }
+    {
+        lock_guard<mutex> lock(GIRObject::pending_toggles_mutex);
+        GIRObject::pending_toggles.insert(object);
+    }
+    uv_async_send(GIRObject::pending_toggles_async);
+}
+
+// the reference count may have changed again since the toggles were queued
+// so we look at what it is now rather than what it was.
+void GIRObject::process_pending_toggles(uv_async_t *async) {
+    unordered_set<GObject *> toggles;
+    {
+        lock_guard<mutex> lock(GIRObject::pending_toggles_mutex);
+        toggles.swap(GIRObject::pending_toggles);
+    }
+    for (GObject *obj : toggles) {
+        GIRObject::set_strong_from_ref_count(obj);
+    }
+
+    // wrappers collected while these are finalized (i.e. by JS signal handlers
+    // run on dispose) are queued again and released on the next callback
+    unordered_set<GObject *> releases;
+    releases.swap(GIRObject::pending_releases);
+    for (GObject *obj : releases) {
+        g_object_remove_toggle_ref(obj, GIRObject::toggle_notify, nullptr);
+    }
+}
+
+// instances is only changed on the JS thread, so this must be called there.
+// Objects without a wrapper (it was collected) are waiting to be released.
+void GIRObject::set_strong_from_ref_count(GObject *obj) {
+    auto instance = GIRObject::instances.find(obj);
+    if (instance != GIRObject::instances.end()) {
+        instance->second->set_strong(g_atomic_int_get(&obj->ref_count) > 1);
     }
 }
 
@@ -55,25 +169,77 @@ GObject *GIRObject::get_gobject() {
     return this->obj;
 }
 
-Local<Value> GIRObject::from_existing(GObject *existing_gobject, GIObjectInfo *object_info) {
+/**
+ * Returns the wrapper of a JS value if it wraps a GObject that is (or implements)
+ * g_type, otherwise nullptr. Every GObject wrapper inherits the GObject.Object template.
+ */
+GIRObject *GIRObject::unwrap(Local<Value> value, GType g_type) {
+    auto root_template = GIRObject::templates.find(G_TYPE_OBJECT);
+    if (!value->IsObject() || root_template == GIRObject::templates.end() ||
+        !Nan::New(root_template->second.object_template)->HasInstance(value)) {
+        return nullptr;
+    }
+    GIRObject *gir_object = Nan::ObjectWrap::Unwrap<GIRObject>(value.As<Object>());
+    if (gir_object->obj == nullptr || !g_type_is_a(G_OBJECT_TYPE(gir_object->obj), g_type)) {
+        return nullptr;
+    }
+    return gir_object;
+}
+
+/**
+ * Returns the JS wrapper for an existing GObject, creating one if needed.
+ * Wrappers hold one strong reference to their GObject. If the object was
+ * transferred to us (transfer full) then that reference is the one we were given,
+ * otherwise we take our own.
+ * object_info is the class the object was declared as, it's only used when the
+ * object's runtime class (and it's ancestors) aren't introspected. It can be
+ * nullptr (i.e. for interface values).
+ */
+Local<Value> GIRObject::from_existing(GObject *existing_gobject, GIObjectInfo *object_info, GITransfer transfer) {
     // sanity check our parameters
     if (existing_gobject == nullptr || !G_IS_OBJECT(existing_gobject)) {
         return Nan::Undefined(); // FIXME: perhaps throw an error?
     }
 
-    // if there's already an existing Wrapper (instance) then return that
+    // if there's already an existing Wrapper (instance) then return that.
+    // it already has a reference so we can drop the one we were given.
     MaybeLocal<Value> existing_gir_object = GIRObject::get_instance(existing_gobject);
     if (!existing_gir_object.IsEmpty()) {
+        if (transfer != GI_TRANSFER_NOTHING) {
+            g_object_unref(existing_gobject);
+        }
         return existing_gir_object.ToLocalChecked();
     }
 
-    // find/create an object template, then initialize it with the existing GObject
-    ObjectFunctionTemplate *oft = GIRObject::find_or_create_template_from_object_info(object_info);
+    // find/create an object template, then initialize it with the existing GObject.
+    // passing the constructor an External tells it not to create a new GObject.
+    // we use the object's actual class (or it's nearest introspected ancestor)
+    // rather than the class the function was declared to return.
+    ObjectFunctionTemplate *oft = GIRObject::find_template_from_g_type(G_OBJECT_TYPE(existing_gobject));
+    if (oft == nullptr && object_info != nullptr) {
+        oft = GIRObject::find_or_create_template_from_object_info(object_info);
+    }
+    if (oft == nullptr) {
+        if (transfer != GI_TRANSFER_NOTHING) {
+            g_object_unref(existing_gobject);
+        }
+        throw UnsupportedGIType(string("no introspected class for ") + G_OBJECT_TYPE_NAME(existing_gobject));
+    }
     Local<Function> instance_constructor = Nan::GetFunction(Nan::New(oft->object_template)).ToLocalChecked();
-    Local<Object> instance = Nan::NewInstance(instance_constructor).ToLocalChecked();
+    Local<Value> constructor_args[] = {Nan::New<External>(existing_gobject)};
+    Local<Object> instance = Nan::NewInstance(instance_constructor, 1, constructor_args).ToLocalChecked();
     GIRObject *gir_wrapper = ObjectWrap::Unwrap<GIRObject>(instance);
     gir_wrapper->info = oft->info;
-    gir_wrapper->obj = existing_gobject; // TODO: should we g_object_ref()?
+    gir_wrapper->obj = existing_gobject;
+    GIRObject::instances[existing_gobject] = gir_wrapper;
+    if (G_OBJECT_TYPE(existing_gobject) != oft->type) {
+        GIRObject::set_private_properties(instance, G_OBJECT_TYPE(existing_gobject), oft->type);
+    }
+    if (transfer == GI_TRANSFER_NOTHING || g_object_is_floating(existing_gobject)) {
+        // ref_sink takes a normal reference if the object isn't floating
+        g_object_ref_sink(existing_gobject);
+    }
+    gir_wrapper->add_toggle_ref();
     return instance;
 }
 
@@ -93,23 +259,22 @@ map<string, GValue> GIRObject::parse_constructor_argument(Local<Object> properti
 }
 
 GType GIRObject::get_object_property_type(GIObjectInfo *object_info, const char *property_name) {
-    void *klass = g_type_class_ref(g_registered_type_info_get_g_type(object_info));
-    GParamSpec *param_spec = g_object_class_find_property(G_OBJECT_CLASS(klass), property_name);
-    g_type_class_unref(klass);
-    if (param_spec == nullptr) {
+    const PropertyDescriptor *property =
+        GIRObject::find_property(g_registered_type_info_get_g_type(object_info), property_name);
+    if (property == nullptr) {
         return G_TYPE_INVALID; // signal that the type doesn't exist or is invalid
                                // because we can't find it!
     }
-    return G_PARAM_SPEC_VALUE_TYPE(param_spec);
+    return property->value_type;
 }
 
 ObjectFunctionTemplate *GIRObject::create_object_template(GIObjectInfo *object_info) {
     Local<External> object_info_extern = Nan::New<External>((void *)g_base_info_ref(object_info));
     Local<FunctionTemplate> object_template = Nan::New<FunctionTemplate>(GIRObject::constructor, object_info_extern);
 
-    ObjectFunctionTemplate *oft = new ObjectFunctionTemplate(); // TODO: where do we deallocate? When the
-                                                                // namespace object (the node module) is
-                                                                // collected?
+    // the template is owned by GIRObject::templates, it lives as long as the process.
+    // the map's elements don't move when it grows so it's safe to keep pointers to them.
+    ObjectFunctionTemplate *oft = &GIRObject::templates[g_registered_type_info_get_g_type(object_info)];
     g_base_info_ref(object_info); // ref the info because we're storing an reference on 'oft'
     oft->info = object_info;
     oft->object_template = PersistentFunctionTemplate(object_template); // TODO: refactor oft->object_template to
@@ -118,7 +283,6 @@ ObjectFunctionTemplate *GIRObject::create_object_template(GIObjectInfo *object_i
     oft->type = g_registered_type_info_get_g_type(object_info);
     oft->type_name = (char *)g_base_info_get_name(object_info);
     oft->namespace_ = (char *)g_base_info_get_namespace(object_info);
-    GIRObject::templates.push_back(oft);
 
     // set the class name
     object_template->SetClassName(Nan::New(oft->type_name).ToLocalChecked());
@@ -126,16 +290,7 @@ ObjectFunctionTemplate *GIRObject::create_object_template(GIObjectInfo *object_i
     // Create instance template
     v8::Local<v8::ObjectTemplate> object_instance_template = object_template->InstanceTemplate();
     object_instance_template->SetInternalFieldCount(1);
-    // Create external to hold GIBaseInfo and set it
-    v8::Handle<v8::External> info_handle = Nan::New<v8::External>((void *)g_base_info_ref(oft->info));
-    // Set properties handlers
-    SetNamedPropertyHandler(object_instance_template,
-                            GIRObject::property_get_handler,
-                            GIRObject::property_set_handler,
-                            GIRObject::property_query_handler,
-                            nullptr,
-                            nullptr,
-                            info_handle);
+    GIRObject::set_properties(object_template, oft->info);
 
     int number_of_constants = g_object_info_get_n_constants(oft->info);
     for (int i = 0; i < number_of_constants; i++) {
@@ -184,12 +339,11 @@ void GIRObject::extend_parent(Local<FunctionTemplate> &object_template, GIObject
 }
 
 ObjectFunctionTemplate *GIRObject::find_template_from_object_info(GIObjectInfo *object_info) {
-    for (auto oft : GIRObject::templates) {
-        if (g_base_info_equal(object_info, oft->info)) {
-            return oft;
-        }
+    auto oft = GIRObject::templates.find(g_registered_type_info_get_g_type(object_info));
+    if (oft == GIRObject::templates.end()) {
+        return nullptr;
     }
-    return nullptr;
+    return &oft->second;
 }
 
 ObjectFunctionTemplate *GIRObject::find_or_create_template_from_object_info(GIObjectInfo *object_info) {
@@ -200,6 +354,166 @@ ObjectFunctionTemplate *GIRObject::find_or_create_template_from_object_info(GIOb
     return oft;
 }
 
+/**
+ * Returns the template of the class with the given GType, creating it if needed.
+ * GTypes that aren't in a loaded typelib (i.e. private subclasses) get the template
+ * of their nearest introspected ancestor and that answer is cached.
+ * Returns nullptr if none of the GType's ancestors are introspected.
+ */
+ObjectFunctionTemplate *GIRObject::find_template_from_g_type(GType g_type) {
+    auto oft = GIRObject::templates.find(g_type);
+    if (oft != GIRObject::templates.end()) {
+        return &oft->second;
+    }
+    auto ancestor_oft = GIRObject::ancestor_templates.find(g_type);
+    if (ancestor_oft != GIRObject::ancestor_templates.end()) {
+        return ancestor_oft->second;
+    }
+
+    GIRepository *repository = g_irepository_get_default();
+    for (GType ancestor = g_type; ancestor != G_TYPE_INVALID; ancestor = g_type_parent(ancestor)) {
+        GIRInfoUniquePtr ancestor_info = GIRInfoUniquePtr(g_irepository_find_by_gtype(repository, ancestor));
+        if (ancestor_info != nullptr && g_base_info_get_type(ancestor_info.get()) == GI_INFO_TYPE_OBJECT) {
+            ObjectFunctionTemplate *found = GIRObject::find_or_create_template_from_object_info(ancestor_info.get());
+            if (ancestor != g_type) {
+                GIRObject::ancestor_templates[g_type] = found;
+            }
+            return found;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * installs an accessor on the prototype for each GObject property the class
+ * declares. Inherited properties are found through the parent's prototype.
+ * Both the canonical name (has-default) and the underscored name (has_default)
+ * are accessible, as g_object_class_find_property accepts either.
+ * The accessors are given their PropertyDescriptor so they don't look anything up.
+ */
+void GIRObject::set_properties(Local<FunctionTemplate> &object_template, GIObjectInfo *object_info) {
+    PropertyTable *properties = GIRObject::get_property_table(g_registered_type_info_get_g_type(object_info));
+    PropertyTable *parent_properties = nullptr;
+    GIObjectInfo *parent_info = g_object_info_get_parent(object_info);
+    if (parent_info != nullptr) {
+        parent_properties = GIRObject::get_property_table(g_registered_type_info_get_g_type(parent_info));
+        g_base_info_unref(parent_info);
+    }
+
+    for (auto &property : *properties) {
+        if (parent_properties != nullptr) {
+            auto parent_property = parent_properties->find(property.first);
+            if (parent_property != parent_properties->end() &&
+                parent_property->second.param_spec == property.second.param_spec) {
+                continue;
+            }
+        }
+        Nan::SetAccessor(object_template->PrototypeTemplate(),
+                         Nan::New(property.first).ToLocalChecked(),
+                         GIRObject::property_getter,
+                         GIRObject::property_setter,
+                         Nan::New<External>((void *)&property.second));
+    }
+}
+
+/**
+ * installs accessors on an instance for the properties of it's runtime class that
+ * the template's class doesn't have. This is for objects of private (not introspected)
+ * subclasses, their template belongs to the nearest introspected ancestor.
+ */
+void GIRObject::set_private_properties(Local<Object> instance, GType g_type, GType template_g_type) {
+    PropertyTable *properties = GIRObject::get_property_table(g_type);
+    PropertyTable *template_properties = GIRObject::get_property_table(template_g_type);
+    for (auto &property : *properties) {
+        if (template_properties->find(property.first) != template_properties->end()) {
+            continue;
+        }
+        Nan::SetAccessor(instance,
+                         Nan::New(property.first).ToLocalChecked(),
+                         GIRObject::property_getter,
+                         GIRObject::property_setter,
+                         Nan::New<External>((void *)&property.second));
+    }
+}
+
+// finds the introspection data of a property on the class or interface that installed it
+static GIPropertyInfo *find_property_info(GParamSpec *pspec) {
+    GIBaseInfo *owner_info = g_irepository_find_by_gtype(g_irepository_get_default(), pspec->owner_type);
+    if (owner_info == nullptr) {
+        return nullptr;
+    }
+    bool is_object = GI_IS_OBJECT_INFO(owner_info);
+    int n_properties = 0;
+    if (is_object) {
+        n_properties = g_object_info_get_n_properties(owner_info);
+    } else if (GI_IS_INTERFACE_INFO(owner_info)) {
+        n_properties = g_interface_info_get_n_properties(owner_info);
+    }
+    GIPropertyInfo *property_info = nullptr;
+    for (int i = 0; i < n_properties && property_info == nullptr; i++) {
+        GIPropertyInfo *candidate = is_object ? g_object_info_get_property(owner_info, i)
+                                              : g_interface_info_get_property(owner_info, i);
+        if (strcmp(g_base_info_get_name(candidate), pspec->name) == 0) {
+            property_info = candidate;
+        } else {
+            g_base_info_unref(candidate);
+        }
+    }
+    g_base_info_unref(owner_info);
+    return property_info;
+}
+
+/**
+ * Returns the properties of a class (including inherited ones), building the table
+ * the first time. Each property is in the table under it's canonical name and, if it
+ * differs, it's underscored name. The tables live as long as the process and so do
+ * the classes (and their param specs), we never unref them.
+ */
+PropertyTable *GIRObject::get_property_table(GType g_type) {
+    auto found = GIRObject::property_tables.find(g_type);
+    if (found != GIRObject::property_tables.end()) {
+        return &found->second;
+    }
+
+    PropertyTable *table = &GIRObject::property_tables[g_type];
+    GObjectClass *klass = G_OBJECT_CLASS(g_type_class_ref(g_type));
+    guint n_properties = 0;
+    GParamSpec **pspecs = g_object_class_list_properties(klass, &n_properties);
+    for (guint i = 0; i < n_properties; i++) {
+        GParamSpec *pspec = pspecs[i];
+        PropertyDescriptor property;
+        property.param_spec = pspec;
+        property.value_type = G_PARAM_SPEC_VALUE_TYPE(pspec);
+        property.readable = (pspec->flags & G_PARAM_READABLE) != 0;
+        property.writable = (pspec->flags & G_PARAM_WRITABLE) != 0;
+        property.property_info = find_property_info(pspec);
+        property.from_g_value = GIRValue::get_from_g_value_function(property.value_type);
+
+        (*table)[g_intern_string(pspec->name)] = property;
+        string name = pspec->name;
+        std::replace(name.begin(), name.end(), '-', '_');
+        if (name != pspec->name) {
+            (*table)[g_intern_string(name.c_str())] = property;
+        }
+    }
+    g_free(pspecs);
+    return table;
+}
+
+const PropertyDescriptor *GIRObject::find_property(GType g_type, const char *name) {
+    // names that were never interned can't be in any table (and we don't intern them)
+    const char *interned_name = g_quark_to_string(g_quark_try_string(name));
+    if (interned_name == nullptr) {
+        return nullptr;
+    }
+    PropertyTable *table = GIRObject::get_property_table(g_type);
+    auto property = table->find(interned_name);
+    if (property == table->end()) {
+        return nullptr;
+    }
+    return &property->second;
+}
+
 void GIRObject::set_custom_prototype_methods(Local<FunctionTemplate> &object_template) {
     // Add our 'connect' method to the target.
     // This method is used to connect signals to the underlying gobject.
@@ -211,26 +525,11 @@ void GIRObject::set_custom_prototype_methods(Local<FunctionTemplate> &object_tem
 }
 
 MaybeLocal<Value> GIRObject::get_instance(GObject *obj) {
-    for (GIRObject *gir_object : GIRObject::instances) {
-        if (gir_object->obj == obj) {
-            return MaybeLocal<Value>(gir_object->handle());
-        }
-    }
-    return MaybeLocal<Value>();
-}
-
-GIPropertyInfo *GIRObject::find_property(GIObjectInfo *object_info,
-                                         char *property_name) { // FIXME: use a unique_pointer with std::move to return
-                                                                // ownership
-    int num_properties = g_object_info_get_n_properties(object_info);
-    for (int i = 0; i < num_properties; i++) {
-        GIPropertyInfo *prop = g_object_info_get_property(object_info, i);
-        if (strcmp(g_base_info_get_name(prop), property_name) == 0) {
-            return prop;
-        }
-        g_base_info_unref(prop);
+    auto instance = GIRObject::instances.find(obj);
+    if (instance == GIRObject::instances.end()) {
+        return MaybeLocal<Value>();
     }
-    return nullptr;
+    return MaybeLocal<Value>(instance->second->handle());
 }
 
 void GIRObject::register_methods(GIObjectInfo *object_info,
@@ -250,30 +549,80 @@ void GIRObject::register_methods(GIObjectInfo *object_info,
         } else {
             function_info = g_interface_info_get_method(object_info, i);
         }
-        GIRObject::set_method(object_template, function_info); // FIXME: if this throws then we leak function_info
+        // FIXME: if this throws then we leak function_info
+        Local<FunctionTemplate> method = GIRObject::set_method(object_template, function_info);
+        GIRObject::set_promise_method(object_template, method, object_info, function_info);
         g_base_info_unref(function_info);
     }
 }
 
+/**
+ * if the function is the first half of a GIO style _async/_finish pair then this
+ * defines a Promise returning version of it (see AsyncReadyCall) next to it, named
+ * without the Async suffix, i.e. `stream.readBytesPromise(count, priority, cancellable)`.
+ * It's also available as the function's promise entry point.
+ * The function itself is unchanged, it still takes a callback.
+ */
+void GIRObject::set_promise_method(Local<FunctionTemplate> &target,
+                                   Local<FunctionTemplate> &method,
+                                   GIObjectInfo *object_info,
+                                   GIFunctionInfo *function_info) {
+    string native_name = g_base_info_get_name(function_info);
+    string suffix = "_async";
+    string base_name = native_name;
+    if (native_name.size() > suffix.size() &&
+        native_name.compare(native_name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+        base_name = native_name.substr(0, native_name.size() - suffix.size());
+    }
+    // some pairs don't have an _async suffix i.e. g_dbus_connection_call/g_dbus_connection_call_finish
+    string finish_name = base_name + "_finish";
+
+    GIFunctionInfo *finish_info = nullptr;
+    if (GI_IS_OBJECT_INFO(object_info)) {
+        finish_info = g_object_info_find_method(object_info, finish_name.c_str());
+    } else {
+        finish_info = g_interface_info_find_method(object_info, finish_name.c_str());
+    }
+    if (finish_info == nullptr) {
+        return;
+    }
+    GIRInfoUniquePtr finish_info_ptr = GIRInfoUniquePtr(finish_info);
+
+    AsyncReadyPlan *plan = AsyncReadyCall::create_plan(function_info, finish_info);
+    if (plan == nullptr) {
+        return;
+    }
+    method->Set(Nan::New("promise").ToLocalChecked(), AsyncReadyCall::create_entry_point(plan));
+    if (plan->start.is_method) {
+        string js_name = Util::to_camel_case(base_name + "_promise");
+        target->PrototypeTemplate()->Set(Nan::New(js_name.c_str()).ToLocalChecked(),
+                                         AsyncReadyCall::create_method(plan));
+    }
+}
+
 /**
  * this function will use the GIFunctionInfo (which describes a native function)
  * to define either a static or prototype method on the target, depending on the
  * flags of the GIFunctionInfo.
  * It will also apply a snake_case to camelCase conversion to function name.
  */
-void GIRObject::set_method(Local<FunctionTemplate> &target, GIFunctionInfo *function_info) {
+Local<FunctionTemplate> GIRObject::set_method(Local<FunctionTemplate> &target, GIFunctionInfo *function_info) {
     const char *native_name = g_base_info_get_name(function_info);
     string js_name = Util::to_camel_case(std::string(native_name));
     Local<String> js_function_name = Nan::New(js_name.c_str()).ToLocalChecked();
+    Local<FunctionTemplate> method;
     if (g_function_info_get_flags(function_info) & GI_FUNCTION_IS_METHOD) {
         // if the function is a method, then we want to set it on the prototype
         // of the target, as a GI_FUNCTION_IS_METHOD is an instance method.
-        target->PrototypeTemplate()->Set(js_function_name, GIRFunction::create_method(function_info));
+        method = GIRFunction::create_method(function_info);
+        target->PrototypeTemplate()->Set(js_function_name, method);
     } else {
         // else if it's not a method, then we want to set it as a static function
         // on the target itgir_object (not the prototype)
-        target->Set(js_function_name, GIRFunction::create_function(function_info));
+        method = GIRFunction::create_function(function_info);
+        target->Set(js_function_name, method);
     }
+    return method;
 }
 
 NAN_METHOD(GIRObject::constructor) {
@@ -292,6 +641,14 @@ NAN_METHOD(GIRObject::constructor) {
         return;
     }
 
+    // GIRObject::from_existing will give the wrapper it's GObject
+    if (info.Length() == 1 && info[0]->IsExternal()) {
+        GIRObject *obj = new GIRObject();
+        obj->Wrap(info.This());
+        info.GetReturnValue().Set(info.This());
+        return;
+    }
+
     map<string, GValue> properties;
     if (info.Length() == 1 && info[0]->IsObject()) {
         properties = GIRObject::parse_constructor_argument(info[0]->ToObject(), object_info);
@@ -299,72 +656,55 @@ NAN_METHOD(GIRObject::constructor) {
 
     GIRObject *obj = new GIRObject(object_info, properties);
     obj->Wrap(info.This());
-    GIRObject::instances.insert(obj);
+    if (obj->get_gobject() != nullptr) {
+        GIRObject::instances[obj->get_gobject()] = obj;
+        obj->add_toggle_ref();
+    }
     info.GetReturnValue().Set(info.This());
 }
 
-NAN_PROPERTY_QUERY(GIRObject::property_query_handler) {
-    // FIXME: implement this
-    String::Utf8Value _name(property);
-    info.GetReturnValue().Set(Nan::New(0));
+// the accessors live on the prototype so they can be reached through objects
+// that aren't wrappers (i.e. the prototype itself, or any object inheriting from it).
+// Returns nullptr for those.
+GIRObject *GIRObject::get_receiver(Local<Object> receiver) {
+    return GIRObject::unwrap(receiver, G_TYPE_OBJECT);
 }
 
-NAN_PROPERTY_GETTER(GIRObject::property_get_handler) {
-    String::Utf8Value _name(property);
-    Handle<External> info_ptr = Handle<External>::Cast(info.Data());
-    GIBaseInfo *base_info = (GIBaseInfo *)info_ptr->Value();
-    if (base_info != nullptr) {
-        GIRObject *that = Nan::ObjectWrap::Unwrap<GIRObject>(info.This()->ToObject());
-        GParamSpec *pspec = g_object_class_find_property(G_OBJECT_GET_CLASS(that->obj), *_name);
-        if (pspec) {
-            // Property is not readable
-            if (!(pspec->flags & G_PARAM_READABLE)) {
-                Nan::ThrowTypeError("property is not readable");
-            }
-            GIPropertyInfo *prop_info = GIRObject::find_property(base_info, *_name);
-            GType value_type = G_TYPE_FUNDAMENTAL(pspec->value_type);
-            GValue gvalue = {0, {{0}}};
-            g_value_init(&gvalue, pspec->value_type);
-            g_object_get_property(G_OBJECT(that->obj), *_name, &gvalue);
-            Local<Value> res = GIRValue::from_g_value(&gvalue, prop_info);
-            if (value_type != G_TYPE_OBJECT && value_type != G_TYPE_BOXED) {
-                g_value_unset(&gvalue);
-            }
-            if (prop_info) {
-                g_base_info_unref(prop_info);
-            }
-            info.GetReturnValue().Set(res);
-            return;
-        }
+NAN_GETTER(GIRObject::property_getter) {
+    const PropertyDescriptor *property = (PropertyDescriptor *)Local<External>::Cast(info.Data())->Value();
+    GIRObject *that = GIRObject::get_receiver(info.This());
+    if (that == nullptr) {
+        info.GetReturnValue().Set(Nan::Undefined());
+        return;
     }
-
-    // Fallback to defaults
-    info.GetReturnValue().Set(info.This()->GetPrototype()->ToObject()->Get(property));
+    if (!property->readable) {
+        Nan::ThrowTypeError("property is not readable");
+        return;
+    }
+    GValue gvalue = {0, {{0}}};
+    g_value_init(&gvalue, property->value_type);
+    g_object_get_property(that->obj, property->param_spec->name, &gvalue);
+    // from_g_value copies (or refs) whatever it needs so we can unset the value
+    Local<Value> res = property->from_g_value != nullptr ? property->from_g_value(&gvalue)
+                                                         : GIRValue::from_g_value(&gvalue, property->property_info);
+    g_value_unset(&gvalue);
+    info.GetReturnValue().Set(res);
 }
 
-NAN_PROPERTY_SETTER(GIRObject::property_set_handler) {
-    String::Utf8Value property_name(property);
-
-    v8::Handle<v8::External> info_ptr = v8::Handle<v8::External>::Cast(info.Data());
-    GIBaseInfo *base_info = (GIBaseInfo *)info_ptr->Value();
-    if (base_info != nullptr) {
-        GIRObject *that = Nan::ObjectWrap::Unwrap<GIRObject>(info.This()->ToObject());
-        GParamSpec *pspec = g_object_class_find_property(G_OBJECT_GET_CLASS(that->obj), *property_name);
-        if (pspec) {
-            // Property is not readable
-            if (!(pspec->flags & G_PARAM_WRITABLE)) {
-                Nan::ThrowTypeError("property is not writable");
-            }
-
-            GValue g_value = GIRValue::to_g_value(value, pspec->value_type);
-            g_object_set_property(that->obj, *property_name, &g_value);
-            g_value_unset(&g_value);
-            return;
-        }
+NAN_SETTER(GIRObject::property_setter) {
+    const PropertyDescriptor *property = (PropertyDescriptor *)Local<External>::Cast(info.Data())->Value();
+    GIRObject *that = GIRObject::get_receiver(info.This());
+    if (that == nullptr) {
+        Nan::ThrowTypeError("property can only be set on an instance");
+        return;
     }
-
-    // Fallback to defaults
-    info.This()->GetPrototype()->ToObject()->Set(property, value);
+    if (!property->writable) {
+        Nan::ThrowTypeError("property is not writable");
+        return;
+    }
+    GValue g_value = GIRValue::to_g_value(value, property->value_type);
+    g_object_set_property(that->obj, property->param_spec->name, &g_value);
+    g_value_unset(&g_value);
 }
 
 /**
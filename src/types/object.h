@@ -3,10 +3,14 @@
 #include <girepository.h>
 #include <glib.h>
 #include <nan.h>
+#include <uv.h>
 #include <v8.h>
 #include <map>
-#include <set>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
+#include "values.h"
 
 namespace gir {
 
@@ -25,26 +29,70 @@ struct ObjectFunctionTemplate {
     char *namespace_;
 };
 
+struct PropertyDescriptor {
+    GParamSpec *param_spec;
+    GType value_type;
+    bool readable;
+    bool writable;
+    GIPropertyInfo *property_info;             // nullptr if the property isn't introspected
+    GIRValue::FromGValueFunction from_g_value; // nullptr if GIRValue::from_g_value is needed
+};
+
+// a class's properties keyed by their interned name (see g_intern_string)
+using PropertyTable = std::unordered_map<const char *, PropertyDescriptor>;
+
 class GIRObject : public Nan::ObjectWrap {
 private:
-    static std::set<GIRObject *> instances;                 // FIXME: use smart pointers
-    static std::vector<ObjectFunctionTemplate *> templates; // FIXME: use smart pointers
-    GObject *obj;
-    GIBaseInfo *info;
+    // every live wrapper keyed by it's GObject, so from_existing can find an
+    // object's wrapper without scanning. Wrappers remove themselves when they're freed.
+    static std::unordered_map<GObject *, GIRObject *> instances;
+    // the templates of the introspected classes we've seen, keyed by their GType
+    static std::unordered_map<GType, ObjectFunctionTemplate> templates;
+    // GTypes without a typelib entry of their own (i.e. private subclasses)
+    // and the template of their nearest introspected ancestor
+    static std::unordered_map<GType, ObjectFunctionTemplate *> ancestor_templates;
+    // the properties of every class we've seen, they're built once and never change
+    static std::unordered_map<GType, PropertyTable> property_tables;
+    GObject *obj = nullptr; // the wrapper holds a toggle reference to obj (see add_toggle_ref)
+    GIBaseInfo *info = nullptr;
+    bool is_strong = false; // true while native code holds other references so JS must keep the wrapper
+
+    // toggle notifications from other threads are handled on the JS thread.
+    // They're queued by GObject, not wrapper, because the wrapper may be freed
+    // before the queue is processed (see process_pending_toggles)
+    static GThread *js_thread;
+    static uv_async_t *pending_toggles_async;
+    static std::mutex pending_toggles_mutex;
+    static std::unordered_set<GObject *> pending_toggles;
+    // GObjects whose wrapper was collected. Their toggle reference is dropped on the
+    // JS thread outside of GC, as that can finalize the object (see ~GIRObject).
+    // Only used on the JS thread.
+    static std::unordered_set<GObject *> pending_releases;
 
 public:
     static Local<Object> prepare(GIObjectInfo *object_info);
-    static Local<Value> from_existing(GObject *obj, GIObjectInfo *object_info);
+    static Local<Value> from_existing(GObject *obj,
+                                      GIObjectInfo *object_info,
+                                      GITransfer transfer = GI_TRANSFER_NOTHING);
     GObject *get_gobject();
+    static GIRObject *unwrap(Local<Value> value, GType g_type);
 
 private:
     GIRObject() = default;
     GIRObject(GIObjectInfo *info_, map<string, GValue> &properties);
+    ~GIRObject();
+
+    void add_toggle_ref();
+    void set_strong(bool strong);
+    static void toggle_notify(gpointer data, GObject *object, gboolean is_last_ref);
+    static void process_pending_toggles(uv_async_t *async);
+    static void set_strong_from_ref_count(GObject *obj);
 
     static MaybeLocal<Value> get_instance(GObject *obj);
     static ObjectFunctionTemplate *create_object_template(GIObjectInfo *object_info);
     static ObjectFunctionTemplate *find_template_from_object_info(GIObjectInfo *object_info);
     static ObjectFunctionTemplate *find_or_create_template_from_object_info(GIObjectInfo *object_info);
+    static ObjectFunctionTemplate *find_template_from_g_type(GType g_type);
 
     static map<string, GValue> parse_constructor_argument(Local<Object> properties_object, GIObjectInfo *object_info);
     static GType get_object_property_type(GIObjectInfo *object_info, const char *property_name);
@@ -52,18 +100,25 @@ private:
     static void register_methods(GIObjectInfo *object_info,
                                  const char *namespace_,
                                  Local<FunctionTemplate> &object_template);
-    static void set_method(Local<FunctionTemplate> &target, GIFunctionInfo *function_info);
+    static Local<FunctionTemplate> set_method(Local<FunctionTemplate> &target, GIFunctionInfo *function_info);
+    static void set_promise_method(Local<FunctionTemplate> &target,
+                                   Local<FunctionTemplate> &method,
+                                   GIObjectInfo *object_info,
+                                   GIFunctionInfo *function_info);
     static void set_custom_fields(Local<FunctionTemplate> &object_template, GIObjectInfo *object_info);
+    static void set_properties(Local<FunctionTemplate> &object_template, GIObjectInfo *object_info);
+    static void set_private_properties(Local<Object> instance, GType g_type, GType template_g_type);
     static void set_custom_prototype_methods(Local<FunctionTemplate> &object_template);
     static void extend_parent(Local<FunctionTemplate> &object_template, GIObjectInfo *object_info);
-    static GIFunctionInfo *find_property(GIObjectInfo *inf, char *name);
+    static PropertyTable *get_property_table(GType g_type);
+    static const PropertyDescriptor *find_property(GType g_type, const char *name);
 
     static NAN_METHOD(constructor);
     static NAN_METHOD(connect);
     static NAN_METHOD(disconnect);
-    static NAN_PROPERTY_GETTER(property_get_handler);
-    static NAN_PROPERTY_SETTER(property_set_handler);
-    static NAN_PROPERTY_QUERY(property_query_handler);
+    static GIRObject *get_receiver(Local<Object> receiver);
+    static NAN_GETTER(property_getter);
+    static NAN_SETTER(property_setter);
 };
 
 } // namespace gir
@@ -7,6 +7,7 @@
 #include "struct.h"
 #include "util.h"
 #include "values.h"
+#include "variant.h"
 
 #include <nan.h>
 #include <node.h>
@@ -22,7 +23,31 @@ gpointer GIRStruct::get_native_ptr() {
     return this->boxed_c_structure;
 }
 
-Local<Value> GIRStruct::from_existing(gpointer c_structure, GIStructInfo *info) {
+/**
+ * Returns the wrapper of a JS value if it wraps a struct of the given type,
+ * otherwise nullptr.
+ */
+GIRStruct *GIRStruct::unwrap(Local<Value> value, GIStructInfo *info) {
+    GType gtype = g_registered_type_info_get_g_type(info);
+    if (!value->IsObject() || !GIRStruct::prepared_js_classes.exists(gtype) ||
+        !Nan::New(GIRStruct::prepared_js_classes.at(gtype))->HasInstance(value)) {
+        return nullptr;
+    }
+    GIRStruct *gir_struct = Nan::ObjectWrap::Unwrap<GIRStruct>(value.As<Object>());
+    if (gir_struct->struct_info == nullptr || !g_base_info_equal(gir_struct->struct_info.get(), info)) {
+        return nullptr;
+    }
+    return gir_struct;
+}
+
+/**
+ * Wraps an existing native struct in a JS object.
+ * If the struct has been transferred to us (transfer full or container, they mean
+ * the same thing for a struct) then the JS object adopts it, otherwise it's copied
+ * because we can't know how long the native memory lives.
+ * GObject interfaces aren't structs, they're wrapped by GIRObject::from_existing.
+ */
+Local<Value> GIRStruct::from_existing(gpointer c_structure, GIStructInfo *info, GITransfer transfer) {
     GType gtype = g_registered_type_info_get_g_type(info);
     Local<Function> klass;
     if (GIRStruct::prepared_js_classes.exists(gtype)) {
@@ -32,29 +57,61 @@ Local<Value> GIRStruct::from_existing(gpointer c_structure, GIStructInfo *info)
     } else {
         klass = GIRStruct::prepare(info);
     }
-    Local<Object> instance = Nan::NewInstance(klass).ToLocalChecked();
+
+    // passing the constructor an External tells it not to allocate a struct
+    // because we're about to give it one.
+    Local<Value> constructor_args[] = {Nan::New<External>(c_structure)};
+    Local<Object> instance = Nan::NewInstance(klass, 1, constructor_args).ToLocalChecked();
     GIRStruct *gir_struct = Nan::ObjectWrap::Unwrap<GIRStruct>(instance);
-    if (g_base_info_get_type(info) == GI_INFO_TYPE_BOXED) {
+    if (gtype == G_TYPE_VARIANT) {
+        // GVariants are ref counted (and maybe floating) rather than boxed
+        gir_struct->boxed_c_structure = c_structure;
+        gir_struct->allocation = StructAllocation::VARIANT;
+        if (transfer == GI_TRANSFER_NOTHING || g_variant_is_floating(static_cast<GVariant *>(c_structure))) {
+            g_variant_ref_sink(static_cast<GVariant *>(c_structure));
+        }
+    } else if (transfer != GI_TRANSFER_NOTHING && G_TYPE_IS_BOXED(gtype)) {
+        // we own the boxed value now so there's no need to copy it
+        gir_struct->boxed_c_structure = c_structure;
+        gir_struct->allocation = StructAllocation::BOXED;
+    } else if (transfer != GI_TRANSFER_NOTHING && (g_base_info_get_type(info) == GI_INFO_TYPE_STRUCT ||
+                                                   g_base_info_get_type(info) == GI_INFO_TYPE_UNION)) {
+        // a plain struct (or union) the callee allocated for us with g_malloc
+        gir_struct->boxed_c_structure = c_structure;
+        gir_struct->allocation = StructAllocation::MALLOC;
+    } else if (G_TYPE_IS_BOXED(gtype)) {
         // copy the boxed value
         gir_struct->boxed_c_structure = g_boxed_copy(gtype, c_structure);
+        gir_struct->allocation = StructAllocation::BOXED;
     } else {
         // allocate directly and copy the struct
         gsize struct_size = g_struct_info_get_size(info);
         gir_struct->boxed_c_structure = g_slice_alloc0(struct_size);
-        gir_struct->slice_allocated = true;
+        gir_struct->allocation = StructAllocation::SLICE;
         memcpy(gir_struct->boxed_c_structure, c_structure, struct_size);
     }
     return instance;
 }
 
 GIRStruct::~GIRStruct() {
-    if (this->boxed_c_structure != nullptr && this->struct_info != nullptr) {
-        if (this->slice_allocated) {
+    if (this->boxed_c_structure == nullptr || this->struct_info == nullptr) {
+        return;
+    }
+    switch (this->allocation) {
+        case StructAllocation::SLICE:
             g_slice_free1(g_struct_info_get_size(this->struct_info.get()), this->boxed_c_structure);
-        } else {
-            GType boxed_type = g_registered_type_info_get_g_type(this->struct_info.get());
-            g_boxed_free(boxed_type, this->boxed_c_structure);
-        }
+            break;
+        case StructAllocation::BOXED:
+            g_boxed_free(g_registered_type_info_get_g_type(this->struct_info.get()), this->boxed_c_structure);
+            break;
+        case StructAllocation::MALLOC:
+            g_free(this->boxed_c_structure);
+            break;
+        case StructAllocation::VARIANT:
+            g_variant_unref(static_cast<GVariant *>(this->boxed_c_structure));
+            break;
+        case StructAllocation::NONE:
+            break;
     }
 }
 
@@ -63,13 +120,17 @@ Local<Function> GIRStruct::prepare(GIStructInfo *info) {
     const char *namespace_ = g_base_info_get_namespace(info);
     g_base_info_ref(info);
 
-    // create a v8 external to reference the GIStructInfo
-    Local<External> struct_info_extern = Nan::New<External>((void *)g_base_info_ref(info));
+    // the native constructor's plan is built once, here, rather than on every `new`
+    StructClass *struct_class = new StructClass();
+    struct_class->struct_info = GIRInfoUniquePtr(g_base_info_ref(info));
+    GIRInfoUniquePtr constructor_info = GIRStruct::find_native_constructor(info);
+    struct_class->constructor_plan = constructor_info != nullptr ? new CallPlan(constructor_info.get()) : nullptr;
+    Local<External> struct_class_extern = Nan::New<External>((void *)struct_class);
 
     // create the struct's constructor
-    // GIRStruct::constructor is expecting the GIStructInfo to be attached
+    // GIRStruct::constructor is expecting the StructClass to be attached
     // to the JS function (constructor)
-    Local<FunctionTemplate> object_template = Nan::New<FunctionTemplate>(GIRStruct::constructor, struct_info_extern);
+    Local<FunctionTemplate> object_template = Nan::New<FunctionTemplate>(GIRStruct::constructor, struct_class_extern);
     GIRStruct::prepared_js_classes.insert(
             make_pair(g_registered_type_info_get_g_type(info), PersistentFunctionTemplate(object_template)));
 
@@ -85,6 +146,9 @@ Local<Function> GIRStruct::prepare(GIStructInfo *info) {
                             GIRStruct::property_query_handler);
 
     GIRStruct::register_methods(info, namespace_, object_template);
+    if (g_registered_type_info_get_g_type(info) == G_TYPE_VARIANT) {
+        GIRVariant::prepare(object_template);
+    }
 
     return object_template->GetFunction();
 }
@@ -104,9 +168,9 @@ void GIRStruct::register_methods(GIStructInfo *info, const char *namespace_, Han
         } else {
             // TODO: refactor GIRFunction::CreateMethod() to support more than GIRObject so
             // we can reuse that logic in here and keep is DRY!
-            Local<External> function_info_extern = Nan::New<External>((void *)g_base_info_ref(func));
-            Local<FunctionTemplate> method_template = Nan::New<FunctionTemplate>(GIRStruct::call_method,
-                                                                                 function_info_extern);
+            Local<External> plan_extern = Nan::New<External>((void *)new CallPlan(func));
+            Local<FunctionTemplate> method_template = Nan::New<FunctionTemplate>(GIRStruct::call_method, plan_extern);
+            GIRFunction::add_entry_points(method_template, plan_extern);
             object_template->PrototypeTemplate()->Set(function_name, method_template);
         }
         g_base_info_unref(func);
@@ -140,26 +204,45 @@ GIRInfoUniquePtr GIRStruct::find_native_constructor(GIStructInfo *struct_info) {
 }
 
 NAN_METHOD(GIRStruct::constructor) {
-    Local<External> struct_info_extern = Local<External>::Cast(info.Data());
-    GIStructInfo *struct_info = (GIStructInfo *)struct_info_extern->Value();
-    auto name = g_base_info_get_name(struct_info);
+    Local<External> struct_class_extern = Local<External>::Cast(info.Data());
+    StructClass *struct_class = (StructClass *)struct_class_extern->Value();
+    GIStructInfo *struct_info = struct_class->struct_info.get();
     GIRStruct *obj = new GIRStruct();
-    obj->struct_info = GIRInfoUniquePtr(struct_info);
-
-    GIRInfoUniquePtr func = GIRStruct::find_native_constructor(struct_info);
-    if (func != nullptr) {
+    obj->struct_info = GIRInfoUniquePtr(g_base_info_ref(struct_info));
+
+    // if we're being created by GIRStruct::from_existing then it will
+    // set the native struct for us.
+    bool from_existing = info.Length() == 1 && info[0]->IsExternal();
+    if (!from_existing && g_registered_type_info_get_g_type(struct_info) == G_TYPE_VARIANT) {
+        // GVariants don't have a default constructor, instead they're
+        // built from a type string and a JS value: new GLib.Variant('a{sv}', {...})
         try {
-            Args args = Args(func.get());
-            args.load_js_arguments(info);
-            GIArgument result = GIRFunction::call_native(func.get(), args);
-            obj->boxed_c_structure = result.v_pointer;
+            obj->boxed_c_structure = g_variant_ref_sink(GIRVariant::from_js(info[0], info[1]));
+            obj->allocation = StructAllocation::VARIANT;
         } catch (exception &error) {
+            delete obj;
             Nan::ThrowError(error.what());
             return;
         }
-    } else {
-        obj->boxed_c_structure = g_slice_alloc0(g_struct_info_get_size(struct_info));
-        obj->slice_allocated = true;
+    } else if (!from_existing) {
+        if (struct_class->constructor_plan != nullptr) {
+            try {
+                const CallPlan &plan = *struct_class->constructor_plan;
+                Args args(plan);
+                args.load_js_arguments(info);
+                GIArgument result = GIRFunction::call_native(plan, args);
+                obj->boxed_c_structure = result.v_pointer;
+                GType gtype = g_registered_type_info_get_g_type(struct_info);
+                obj->allocation = G_TYPE_IS_BOXED(gtype) ? StructAllocation::BOXED : StructAllocation::MALLOC;
+            } catch (exception &error) {
+                delete obj;
+                Nan::ThrowError(error.what());
+                return;
+            }
+        } else {
+            obj->boxed_c_structure = g_slice_alloc0(g_struct_info_get_size(struct_info));
+            obj->allocation = StructAllocation::SLICE;
+        }
     }
 
     obj->Wrap(info.This());
@@ -167,7 +250,7 @@ NAN_METHOD(GIRStruct::constructor) {
     // if we allocated the struct directly and if a 'properties'
     // object was passed to the constructor, then use the object
     // to set inital values for properties on the struct
-    if (obj->slice_allocated && info.Length() == 1 && info[0]->IsObject()) {
+    if (obj->allocation == StructAllocation::SLICE && info.Length() == 1 && info[0]->IsObject()) {
         Local<Object> properties = info[0]->ToObject();
         Local<Array> property_names = properties->GetPropertyNames();
         for (size_t i = 0; i < property_names->Length(); i++) {
@@ -181,10 +264,10 @@ NAN_METHOD(GIRStruct::constructor) {
 }
 
 NAN_METHOD(GIRStruct::call_method) {
-    Local<External> function_info_extern = Local<External>::Cast(info.Data());
-    GIFunctionInfo *function_info = (GIFunctionInfo *)function_info_extern->Value();
+    Local<External> plan_extern = Local<External>::Cast(info.Data());
+    CallPlan *plan = (CallPlan *)plan_extern->Value();
     GIRStruct *that = Nan::ObjectWrap::Unwrap<GIRStruct>(info.This()->ToObject());
-    Local<Value> result = GIRFunction::call((GObject *)that->boxed_c_structure, function_info, info);
+    Local<Value> result = GIRFunction::call((GObject *)that->boxed_c_structure, *plan, info);
     info.GetReturnValue().Set(result);
 }
 
@@ -222,7 +305,7 @@ NAN_PROPERTY_GETTER(GIRStruct::property_get_handler) {
 
     // converty the native value to a JS value
     auto type_info = GIRInfoUniquePtr(g_field_info_get_type(field_info.get()));
-    Local<Value> res = Args::from_g_type(&native_field_value, type_info.get(), 0);
+    Local<Value> res = Args::from_g_type(&native_field_value, type_info.get(), -1);
     info.GetReturnValue().Set(res);
     return;
 }
@@ -247,8 +330,11 @@ NAN_PROPERTY_SETTER(GIRStruct::property_set_handler) {
     }
 
     // otherwise set the native field
+    // g_field_info_set_field copies the value into the struct so
+    // temporaries can be released once it's been set.
     auto type_info = GIRInfoUniquePtr(g_field_info_get_type(field_info.get()));
-    GIArgument native_value = Args::type_to_g_type(*type_info, value);
+    Arena arena;
+    GIArgument native_value = Args::type_to_g_type(*type_info, value, &arena);
     bool successfully_set = g_field_info_set_field(field_info.get(), gir_struct->boxed_c_structure, &native_value);
     if (!successfully_set) {
         stringstream message;
@@ -16,25 +16,40 @@ using namespace v8;
 using PersistentFunctionTemplate = Nan::Persistent<FunctionTemplate, CopyablePersistentTraits<FunctionTemplate>>;
 
 class GIRStruct;
+class CallPlan;
+
+// how a GIRStruct's native memory was allocated, so that
+// we can free it the same way.
+enum class StructAllocation {
+    NONE,    // not owned by us
+    SLICE,   // allocated (or copied) by us with g_slice_alloc0
+    BOXED,   // a boxed type that we own, freed with g_boxed_free
+    MALLOC,  // a non-boxed struct transferred to us by a native function
+    VARIANT, // a GVariant that we hold a reference on
+};
+
+// the data of a struct's JS constructor. Like the class, it's never freed.
+struct StructClass {
+    GIRInfoUniquePtr struct_info;
+    CallPlan *constructor_plan; // the native constructor's plan or nullptr if we allocate the struct
+};
 
 class GIRStruct : public Nan::ObjectWrap {
 public:
     gpointer get_native_ptr();
+    static GIRStruct *unwrap(Local<Value> value, GIStructInfo *info);
 
     static Local<Function> prepare(GIStructInfo *info);
-    static Local<Value> from_existing(gpointer boxed_c_structure, GIStructInfo *info);
+    static Local<Value> from_existing(gpointer boxed_c_structure,
+                                      GIStructInfo *info,
+                                      GITransfer transfer = GI_TRANSFER_NOTHING);
 
 private:
     static PersistentObjectStore<GType, PersistentFunctionTemplate> prepared_js_classes;
 
     gpointer boxed_c_structure = nullptr;
     GIRInfoUniquePtr struct_info = nullptr;
-
-    // when we create GIRStructs in `prepare()` we sometimes
-    // allocate memory for the struct ourselves (rather than using
-    // `g_boxed_copy()` so we need to remember which we did so we
-    // can clean up appropriately)
-    bool slice_allocated = false;
+    StructAllocation allocation = StructAllocation::NONE;
 
     static GIRInfoUniquePtr find_native_constructor(GIStructInfo *struct_info);
     static void register_methods(GIStructInfo *info, const char *namespace_, Local<FunctionTemplate> object_template);
@@ -0,0 +1,441 @@
+#include <exception>
+#include <sstream>
+#include <vector>
+
+#include "arguments.h"
+#include "exceptions.h"
+#include "types/struct.h"
+#include "types/variant.h"
+
+namespace gir {
+
+using namespace std;
+
+Nan::Persistent<FunctionTemplate> GIRVariant::variant_template;
+
+/**
+ * adds the GLib.Variant specific methods to it's JS class.
+ * GIRStruct::prepare calls this when it prepares the GLib.Variant struct.
+ */
+void GIRVariant::prepare(Local<FunctionTemplate> variant_template) {
+    GIRVariant::variant_template.Reset(variant_template);
+    Nan::SetPrototypeMethod(variant_template, "unpack", GIRVariant::unpack);
+}
+
+bool GIRVariant::is_variant(Local<Value> js_value) {
+    if (GIRVariant::variant_template.IsEmpty() || !js_value->IsObject()) {
+        return false;
+    }
+    return Nan::New(GIRVariant::variant_template)->HasInstance(js_value);
+}
+
+/**
+ * returns the GITypeTag for the elements of an array that can be read with
+ * g_variant_get_fixed_array (i.e. 'ay', 'ai', 'ad') or GI_TYPE_TAG_VOID if the
+ * elements aren't fixed size numbers.
+ */
+GITypeTag GIRVariant::fixed_array_element_tag(const GVariantType *element_type, gsize *element_size) {
+    switch (g_variant_type_peek_string(element_type)[0]) {
+        case 'y':
+            *element_size = sizeof(guint8);
+            return GI_TYPE_TAG_UINT8;
+        case 'n':
+            *element_size = sizeof(gint16);
+            return GI_TYPE_TAG_INT16;
+        case 'q':
+            *element_size = sizeof(guint16);
+            return GI_TYPE_TAG_UINT16;
+        case 'i':
+        case 'h':
+            *element_size = sizeof(gint32);
+            return GI_TYPE_TAG_INT32;
+        case 'u':
+            *element_size = sizeof(guint32);
+            return GI_TYPE_TAG_UINT32;
+        case 'x':
+            *element_size = sizeof(gint64);
+            return GI_TYPE_TAG_INT64;
+        case 't':
+            *element_size = sizeof(guint64);
+            return GI_TYPE_TAG_UINT64;
+        case 'd':
+            *element_size = sizeof(gdouble);
+            return GI_TYPE_TAG_DOUBLE;
+        default:
+            *element_size = 0;
+            return GI_TYPE_TAG_VOID;
+    }
+}
+
+/**
+ * Converts a GVariant into a JS value by walking it's type once.
+ * The variant isn't consumed; the caller still owns it.
+ */
+Local<Value> GIRVariant::to_js(GVariant *variant) {
+    switch (g_variant_classify(variant)) {
+        case G_VARIANT_CLASS_BOOLEAN:
+            return Nan::New<Boolean>(g_variant_get_boolean(variant));
+
+        case G_VARIANT_CLASS_BYTE:
+            return Nan::New<Number>(g_variant_get_byte(variant));
+
+        case G_VARIANT_CLASS_INT16:
+            return Nan::New<Number>(g_variant_get_int16(variant));
+
+        case G_VARIANT_CLASS_UINT16:
+            return Nan::New<Number>(g_variant_get_uint16(variant));
+
+        case G_VARIANT_CLASS_INT32:
+            return Nan::New<Number>(g_variant_get_int32(variant));
+
+        case G_VARIANT_CLASS_UINT32:
+            return Nan::New<Number>(g_variant_get_uint32(variant));
+
+        case G_VARIANT_CLASS_HANDLE:
+            return Nan::New<Number>(g_variant_get_handle(variant));
+
+        case G_VARIANT_CLASS_INT64:
+            // like Args::from_g_type this loses precision for
+            // values with more than 53 significant bits.
+            return Nan::New<Number>(static_cast<double>(g_variant_get_int64(variant)));
+
+        case G_VARIANT_CLASS_UINT64:
+            return Nan::New<Number>(static_cast<double>(g_variant_get_uint64(variant)));
+
+        case G_VARIANT_CLASS_DOUBLE:
+            return Nan::New<Number>(g_variant_get_double(variant));
+
+        case G_VARIANT_CLASS_STRING:
+        case G_VARIANT_CLASS_OBJECT_PATH:
+        case G_VARIANT_CLASS_SIGNATURE: {
+            gsize length;
+            const gchar *string = g_variant_get_string(variant, &length);
+            return Nan::New(string, length).ToLocalChecked();
+        }
+
+        case G_VARIANT_CLASS_VARIANT: {
+            GVariant *child = g_variant_get_variant(variant);
+            Local<Value> js_value = GIRVariant::to_js(child);
+            g_variant_unref(child);
+            return js_value;
+        }
+
+        case G_VARIANT_CLASS_MAYBE: {
+            GVariant *child = g_variant_get_maybe(variant);
+            if (child == nullptr) {
+                return Nan::Null();
+            }
+            Local<Value> js_value = GIRVariant::to_js(child);
+            g_variant_unref(child);
+            return js_value;
+        }
+
+        case G_VARIANT_CLASS_ARRAY:
+            return GIRVariant::array_to_js(variant);
+
+        case G_VARIANT_CLASS_TUPLE:
+        case G_VARIANT_CLASS_DICT_ENTRY: {
+            // dict entries outside of a dictionary are unpacked as [key, value]
+            gsize n_children = g_variant_n_children(variant);
+            Local<Array> js_tuple = Nan::New<Array>(n_children);
+            for (gsize i = 0; i < n_children; i++) {
+                GVariant *child = g_variant_get_child_value(variant, i);
+                Nan::Set(js_tuple, i, GIRVariant::to_js(child));
+                g_variant_unref(child);
+            }
+            return js_tuple;
+        }
+
+        default:
+            stringstream message;
+            message << "cannot convert a GVariant of type '" << g_variant_get_type_string(variant) << "' to a JS value";
+            throw UnsupportedGIType(message.str());
+    }
+}
+
+/**
+ * arrays of fixed size numbers are copied into a TypedArray in one go,
+ * dictionaries (arrays of dict entries) become Maps and everything else
+ * becomes a JS Array.
+ */
+Local<Value> GIRVariant::array_to_js(GVariant *variant) {
+    const GVariantType *element_type = g_variant_type_element(g_variant_get_type(variant));
+
+    gsize element_size;
+    GITypeTag fixed_element_tag = GIRVariant::fixed_array_element_tag(element_type, &element_size);
+    if (fixed_element_tag != GI_TYPE_TAG_VOID) {
+        gsize length = 0;
+        gconstpointer data = g_variant_get_fixed_array(variant, &length, element_size);
+        return Args::from_g_type_numeric_array(const_cast<gpointer>(data), length, fixed_element_tag);
+    }
+
+    GVariantIter iter;
+    GVariant *child;
+    g_variant_iter_init(&iter, variant);
+
+    if (g_variant_type_is_dict_entry(element_type)) {
+        Local<Context> context = Nan::GetCurrentContext();
+        Local<Map> js_map = Map::New(Isolate::GetCurrent());
+        while ((child = g_variant_iter_next_value(&iter)) != nullptr) {
+            GVariant *key = g_variant_get_child_value(child, 0);
+            GVariant *value = g_variant_get_child_value(child, 1);
+            js_map->Set(context, GIRVariant::to_js(key), GIRVariant::to_js(value)).ToLocalChecked();
+            g_variant_unref(key);
+            g_variant_unref(value);
+            g_variant_unref(child);
+        }
+        return js_map;
+    }
+
+    Local<Array> js_array = Nan::New<Array>(g_variant_iter_n_children(&iter));
+    for (uint32_t i = 0; (child = g_variant_iter_next_value(&iter)) != nullptr; i++) {
+        Nan::Set(js_array, i, GIRVariant::to_js(child));
+        g_variant_unref(child);
+    }
+    return js_array;
+}
+
+/**
+ * Builds a GVariant of the given type from a JS value.
+ * The returned GVariant is floating.
+ */
+GVariant *GIRVariant::from_js(Local<Value> js_value, const GVariantType *type) {
+    const gchar *type_string = g_variant_type_peek_string(type);
+    switch (type_string[0]) {
+        case 'b':
+            return g_variant_new_boolean(js_value->BooleanValue());
+        case 'y':
+            return g_variant_new_byte(js_value->Uint32Value());
+        case 'n':
+            return g_variant_new_int16(js_value->Int32Value());
+        case 'q':
+            return g_variant_new_uint16(js_value->Uint32Value());
+        case 'i':
+            return g_variant_new_int32(js_value->Int32Value());
+        case 'u':
+            return g_variant_new_uint32(js_value->Uint32Value());
+        case 'h':
+            return g_variant_new_handle(js_value->Int32Value());
+        case 'x':
+            return g_variant_new_int64(js_value->IntegerValue());
+        case 't':
+            return g_variant_new_uint64(js_value->NumberValue());
+        case 'd':
+            return g_variant_new_double(js_value->NumberValue());
+
+        case 's':
+        case 'o':
+        case 'g': {
+            if (!js_value->IsString()) {
+                throw JSArgumentTypeError("expected a string for a GVariant of type '" + string(1, type_string[0]) +
+                                          "'");
+            }
+            Nan::Utf8String js_string(js_value);
+            if (type_string[0] == 'o' && !g_variant_is_object_path(*js_string)) {
+                throw JSValueError("'" + string(*js_string) + "' is not a valid D-Bus object path");
+            }
+            if (type_string[0] == 'g' && !g_variant_is_signature(*js_string)) {
+                throw JSValueError("'" + string(*js_string) + "' is not a valid D-Bus signature");
+            }
+            if (type_string[0] == 'o') {
+                return g_variant_new_object_path(*js_string);
+            }
+            if (type_string[0] == 'g') {
+                return g_variant_new_signature(*js_string);
+            }
+            return g_variant_new_string(*js_string);
+        }
+
+        case 'v':
+            if (GIRVariant::is_variant(js_value)) {
+                GIRStruct *gir_struct = Nan::ObjectWrap::Unwrap<GIRStruct>(js_value->ToObject());
+                return g_variant_new_variant(static_cast<GVariant *>(gir_struct->get_native_ptr()));
+            }
+            return g_variant_new_variant(GIRVariant::guess_variant(js_value));
+
+        case 'm': {
+            const GVariantType *element_type = g_variant_type_element(type);
+            if (js_value->IsNullOrUndefined()) {
+                return g_variant_new_maybe(element_type, nullptr);
+            }
+            return g_variant_new_maybe(element_type, GIRVariant::from_js(js_value, element_type));
+        }
+
+        case 'a':
+            return GIRVariant::array_from_js(js_value, type);
+
+        case '(':
+        case '{':
+            return GIRVariant::tuple_from_js(js_value, type);
+
+        default:
+            stringstream message;
+            message << "cannot build a GVariant of type '" << type_string << "', it's not a definite type";
+            throw JSValueError(message.str());
+    }
+}
+
+/**
+ * Builds a GVariant from a JS type string (i.e. 'a{sv}') and value.
+ */
+GVariant *GIRVariant::from_js(Local<Value> js_type_string, Local<Value> js_value) {
+    if (!js_type_string->IsString()) {
+        throw JSArgumentTypeError("expected a GVariant type string as the first argument");
+    }
+    Nan::Utf8String type_string(js_type_string);
+    if (!g_variant_type_string_is_valid(*type_string)) {
+        throw JSValueError("'" + string(*type_string) + "' is not a valid GVariant type string");
+    }
+    GVariantType *type = g_variant_type_new(*type_string);
+    try {
+        GVariant *variant = GIRVariant::from_js(js_value, type);
+        g_variant_type_free(type);
+        return variant;
+    } catch (...) {
+        g_variant_type_free(type);
+        throw;
+    }
+}
+
+/**
+ * TypedArrays (and Buffers for 'ay') with the same element type as the
+ * array are copied in one go with g_variant_new_fixed_array. Maps and plain
+ * objects are converted to dictionaries and everything else is built
+ * element by element.
+ */
+GVariant *GIRVariant::array_from_js(Local<Value> js_value, const GVariantType *type) {
+    const GVariantType *element_type = g_variant_type_element(type);
+
+    gsize element_size;
+    GITypeTag fixed_element_tag = GIRVariant::fixed_array_element_tag(element_type, &element_size);
+    bool is_raw_bytes = fixed_element_tag == GI_TYPE_TAG_UINT8 && js_value->IsArrayBufferView();
+    if (fixed_element_tag != GI_TYPE_TAG_VOID &&
+        (is_raw_bytes || Args::typed_array_matches(js_value, fixed_element_tag))) {
+        Local<ArrayBufferView> view = js_value.As<ArrayBufferView>();
+        guint8 *data = static_cast<guint8 *>(view->Buffer()->GetContents().Data()) + view->ByteOffset();
+        return g_variant_new_fixed_array(element_type, data, view->ByteLength() / element_size, element_size);
+    }
+
+    GVariantBuilder builder;
+    g_variant_builder_init(&builder, type);
+    try {
+        if (g_variant_type_is_dict_entry(element_type)) {
+            if (!js_value->IsObject()) {
+                throw JSArgumentTypeError("expected a Map or an object for a GVariant dictionary");
+            }
+            const GVariantType *key_type = g_variant_type_key(element_type);
+            const GVariantType *value_type = g_variant_type_value(element_type);
+            Local<Object> js_object = js_value->ToObject();
+            // a Map flattens to [key, value, key, value, ...]
+            bool is_map = js_value->IsMap();
+            Local<Array> entries = is_map ? js_value.As<Map>()->AsArray()
+                                          : Nan::GetOwnPropertyNames(js_object).ToLocalChecked();
+            uint32_t n_entries = is_map ? entries->Length() / 2 : entries->Length();
+            for (uint32_t i = 0; i < n_entries; i++) {
+                Local<Value> js_key = Nan::Get(entries, is_map ? i * 2 : i).ToLocalChecked();
+                Local<Value> js_entry_value = is_map ? Nan::Get(entries, i * 2 + 1).ToLocalChecked()
+                                                     : Nan::Get(js_object, js_key).ToLocalChecked();
+                GVariant *key = GIRVariant::from_js(js_key, key_type);
+                GVariant *value = nullptr;
+                try {
+                    value = GIRVariant::from_js(js_entry_value, value_type);
+                } catch (...) {
+                    g_variant_unref(g_variant_ref_sink(key));
+                    throw;
+                }
+                g_variant_builder_add_value(&builder, g_variant_new_dict_entry(key, value));
+            }
+        } else {
+            if (!js_value->IsArray() && !js_value->IsTypedArray()) {
+                throw JSArgumentTypeError("expected an array for a GVariant array");
+            }
+            Local<Object> js_array = js_value->ToObject();
+            uint32_t length = js_value->IsArray() ? js_value.As<Array>()->Length()
+                                                  : js_value.As<TypedArray>()->Length();
+            for (uint32_t i = 0; i < length; i++) {
+                Local<Value> js_element = Nan::Get(js_array, i).ToLocalChecked();
+                g_variant_builder_add_value(&builder, GIRVariant::from_js(js_element, element_type));
+            }
+        }
+    } catch (...) {
+        g_variant_builder_clear(&builder);
+        throw;
+    }
+    return g_variant_builder_end(&builder);
+}
+
+/**
+ * tuples and dict entries are built from JS arrays, i.e. [key, value] for a dict entry.
+ */
+GVariant *GIRVariant::tuple_from_js(Local<Value> js_value, const GVariantType *type) {
+    gsize n_items = g_variant_type_n_items(type);
+    if (!js_value->IsArray() || js_value.As<Array>()->Length() != n_items) {
+        stringstream message;
+        message << "expected an array of " << n_items << " items for a GVariant of type '";
+        message << string(g_variant_type_peek_string(type), g_variant_type_get_string_length(type)) << "'";
+        throw JSArgumentTypeError(message.str());
+    }
+
+    Local<Array> js_array = js_value.As<Array>();
+    vector<GVariant *> children;
+    children.reserve(n_items);
+    try {
+        const GVariantType *item_type = g_variant_type_first(type);
+        for (uint32_t i = 0; item_type != nullptr; i++, item_type = g_variant_type_next(item_type)) {
+            children.push_back(GIRVariant::from_js(Nan::Get(js_array, i).ToLocalChecked(), item_type));
+        }
+    } catch (...) {
+        for (GVariant *child : children) {
+            g_variant_unref(g_variant_ref_sink(child));
+        }
+        throw;
+    }
+
+    if (g_variant_type_is_dict_entry(type)) {
+        return g_variant_new_dict_entry(children[0], children[1]);
+    }
+    return g_variant_new_tuple(children.data(), children.size());
+}
+
+/**
+ * the value of a 'v' can be any type so (like GIRValue::guess_type) we
+ * guess it from the JS value. Use a GLib.Variant to be explicit.
+ */
+GVariant *GIRVariant::guess_variant(Local<Value> js_value) {
+    if (js_value->IsString()) {
+        return GIRVariant::from_js(js_value, G_VARIANT_TYPE_STRING);
+    }
+    if (js_value->IsBoolean()) {
+        return GIRVariant::from_js(js_value, G_VARIANT_TYPE_BOOLEAN);
+    }
+    if (js_value->IsInt32()) {
+        return GIRVariant::from_js(js_value, G_VARIANT_TYPE_INT32);
+    }
+    if (js_value->IsNumber()) {
+        return GIRVariant::from_js(js_value, G_VARIANT_TYPE_DOUBLE);
+    }
+    throw JSValueError("can't guess the GVariant type of the value, use a GLib.Variant instead");
+}
+
+/**
+ * variant.unpack() converts the variant into JS values.
+ */
+NAN_METHOD(GIRVariant::unpack) {
+    if (!GIRVariant::is_variant(info.This())) {
+        Nan::ThrowTypeError("the value of 'this' should be a GLib.Variant");
+        return;
+    }
+    GIRStruct *gir_struct = Nan::ObjectWrap::Unwrap<GIRStruct>(info.This());
+    GVariant *variant = static_cast<GVariant *>(gir_struct->get_native_ptr());
+    if (variant == nullptr) {
+        info.GetReturnValue().Set(Nan::Null());
+        return;
+    }
+    try {
+        info.GetReturnValue().Set(GIRVariant::to_js(variant));
+    } catch (std::exception &error) {
+        Nan::ThrowError(error.what());
+    }
+}
+
+} // namespace gir
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <girepository.h>
+#include <glib.h>
+#include <nan.h>
+#include <v8.h>
+
+namespace gir {
+
+using namespace v8;
+
+/**
+ * Converts between GVariants and JS values.
+ * GVariants are exposed to JS as GLib.Variant structs (see GIRStruct). This class
+ * adds the GLib.Variant specific bits to that JS class:
+ * - `new GLib.Variant(typeString, value)` builds a GVariant of the given type
+ * - `variant.unpack()` recursively converts a GVariant into JS values
+ * Arrays of fixed size numbers (i.e. 'ay', 'ai', 'ad') are converted to
+ * TypedArrays in one go, dictionaries ('a{sv}') to Maps and tuples to Arrays.
+ */
+class GIRVariant {
+public:
+    static void prepare(Local<FunctionTemplate> variant_template);
+    static bool is_variant(Local<Value> js_value);
+    static Local<Value> to_js(GVariant *variant);
+    static GVariant *from_js(Local<Value> js_value, const GVariantType *type);
+    static GVariant *from_js(Local<Value> js_type_string, Local<Value> js_value);
+
+private:
+    static Nan::Persistent<FunctionTemplate> variant_template;
+
+    static Local<Value> array_to_js(GVariant *variant);
+    static GVariant *array_from_js(Local<Value> js_value, const GVariantType *type);
+    static GVariant *tuple_from_js(Local<Value> js_value, const GVariantType *type);
+    static GVariant *guess_variant(Local<Value> js_value);
+    static GITypeTag fixed_array_element_tag(const GVariantType *element_type, gsize *element_size);
+
+    static NAN_METHOD(unpack);
+};
+
+} // namespace gir
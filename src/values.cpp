@@ -9,6 +9,7 @@
 #include "types/object.h"
 #include "types/param_spec.h"
 #include "types/struct.h"
+#include "types/variant.h"
 
 using namespace v8;
 
@@ -73,11 +74,26 @@ Local<Value> GIRValue::from_g_value(const GValue *gvalue, GITypeInfo *type_info)
             if (G_VALUE_TYPE(gvalue) == G_TYPE_ARRAY) {
                 throw UnsupportedGValueType("GIRValue - GValueArray conversion not supported");
             } else {
+                gpointer boxed = g_value_get_boxed(gvalue);
+                if (boxed == nullptr) {
+                    return Nan::Null();
+                }
+                // the GValue owns the boxed value so from_existing will copy it
                 GIBaseInfo *boxed_info = g_irepository_find_by_gtype(g_irepository_get_default(), G_VALUE_TYPE(gvalue));
-                return GIRStruct::from_existing((GIRStruct *)g_value_get_boxed(gvalue), boxed_info);
+                return GIRStruct::from_existing(boxed, boxed_info);
             }
             break;
 
+        case G_TYPE_VARIANT: {
+            GVariant *variant = g_value_get_variant(gvalue);
+            if (variant == nullptr) {
+                return Nan::Null();
+            }
+            GIRInfoUniquePtr variant_info =
+                GIRInfoUniquePtr(g_irepository_find_by_gtype(g_irepository_get_default(), G_TYPE_VARIANT));
+            return GIRStruct::from_existing(variant, variant_info.get());
+        } break;
+
         case G_TYPE_OBJECT: {
             GIBaseInfo *object_info = g_irepository_find_by_gtype(g_irepository_get_default(), G_VALUE_TYPE(gvalue));
             return GIRObject::from_existing(G_OBJECT(g_value_get_object(gvalue)), object_info);
@@ -91,6 +107,71 @@ Local<Value> GIRValue::from_g_value(const GValue *gvalue, GITypeInfo *type_info)
     }
 }
 
+static Local<Value> boolean_from_g_value(const GValue *gvalue) {
+    return Nan::New<Boolean>(g_value_get_boolean(gvalue));
+}
+
+static Local<Value> int_from_g_value(const GValue *gvalue) {
+    return Nan::New(g_value_get_int(gvalue));
+}
+
+static Local<Value> uint_from_g_value(const GValue *gvalue) {
+    return Nan::New(g_value_get_uint(gvalue));
+}
+
+static Local<Value> enum_from_g_value(const GValue *gvalue) {
+    return Nan::New(g_value_get_enum(gvalue));
+}
+
+static Local<Value> flags_from_g_value(const GValue *gvalue) {
+    return Nan::New(g_value_get_flags(gvalue));
+}
+
+static Local<Value> float_from_g_value(const GValue *gvalue) {
+    return Nan::New(g_value_get_float(gvalue));
+}
+
+static Local<Value> double_from_g_value(const GValue *gvalue) {
+    return Nan::New(g_value_get_double(gvalue));
+}
+
+static Local<Value> string_from_g_value(const GValue *gvalue) {
+    const gchar *str = g_value_get_string(gvalue);
+    if (str == nullptr) {
+        return Nan::Null();
+    }
+    return Nan::New(str).ToLocalChecked();
+}
+
+/**
+ * Returns a function that converts GValues of the given type without going through
+ * from_g_value's switch, so callers that know the type ahead of time (i.e. object
+ * properties) can pick the conversion once. Returns nullptr for the types that need
+ * the full from_g_value.
+ */
+GIRValue::FromGValueFunction GIRValue::get_from_g_value_function(GType g_type) {
+    switch (G_TYPE_FUNDAMENTAL(g_type)) {
+        case G_TYPE_BOOLEAN:
+            return boolean_from_g_value;
+        case G_TYPE_INT:
+            return int_from_g_value;
+        case G_TYPE_UINT:
+            return uint_from_g_value;
+        case G_TYPE_ENUM:
+            return enum_from_g_value;
+        case G_TYPE_FLAGS:
+            return flags_from_g_value;
+        case G_TYPE_FLOAT:
+            return float_from_g_value;
+        case G_TYPE_DOUBLE:
+            return double_from_g_value;
+        case G_TYPE_STRING:
+            return string_from_g_value;
+        default:
+            return nullptr;
+    }
+}
+
 // TODO: refactor to follow the style that Args::ToGType does
 // i.e. return a GValue and throw std::exceptions on failure
 GValue GIRValue::to_g_value(Local<Value> js_value, GType g_type) {
@@ -187,6 +268,14 @@ GValue GIRValue::to_g_value(Local<Value> js_value, GType g_type) {
             }
             break;
 
+        case G_TYPE_VARIANT:
+            if (!GIRVariant::is_variant(js_value)) {
+                throw JSValueError("expected a GLib.Variant");
+            }
+            g_value_set_variant(&g_value,
+                                (GVariant *)Nan::ObjectWrap::Unwrap<GIRStruct>(js_value->ToObject())->get_native_ptr());
+            break;
+
         case G_TYPE_PARAM:
         case G_TYPE_POINTER: {
             stringstream message;
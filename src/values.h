@@ -10,8 +10,12 @@ using namespace v8;
 
 class GIRValue {
 public:
+    // converts a GValue of one specific fundamental type, see get_from_g_value_function
+    using FromGValueFunction = Local<Value> (*)(const GValue *v);
+
     static GValue to_g_value(Local<Value> value, GType g_type);
     static Local<Value> from_g_value(const GValue *v, GITypeInfo *type_info);
+    static FromGValueFunction get_from_g_value_function(GType g_type);
 
 private:
     static GType guess_type(Local<Value> value);